@@ -1,5 +1,8 @@
 #include <pet/Script.hpp>
+#include <pet/ScriptCache.hpp>
 
+#include <toolkit/Exception.hpp>
+#include <toolkit/Macro.hpp>
 #include <toolkit/StringUtils.hpp>
 
 #include <fstream>
@@ -18,22 +21,92 @@ namespace
 		std::exit(EXIT_SUCCESS);
 	}
 
-	using CommandHandlerType = std::function<void(Script&, const std::vector<std::string>&)>;
-	std::unordered_map<std::string_view, CommandHandlerType> CommandHandlers = {{"quit", std::bind(ProcessQuitCommand)}};
+	void ProcessSaveCommand(Script& script, const std::vector<std::string_view>& args)
+	{
+		PET_CHECK(args.size() == 2, Exception("Usage: $save <path>"));
+		script.SaveSnapshot(std::string(args[1]));
+	}
+
+	void ProcessLoadCommand(Script& script, const std::vector<std::string_view>& args)
+	{
+		PET_CHECK(args.size() == 2, Exception("Usage: $load <path>"));
+		script.LoadSnapshot(std::string(args[1]));
+	}
+
+	using CommandHandlerType = std::function<void(Script&, const std::vector<std::string_view>&)>;
+	std::unordered_map<std::string_view, CommandHandlerType> CommandHandlers = {
+		{"quit", std::bind(ProcessQuitCommand)}, {"save", ProcessSaveCommand}, {"load", ProcessLoadCommand}};
+
+	// Options come before the script: --load-snapshot <path> starts from a saved state, --save-snapshot <path> saves the state
+	// left by the script, --cache keeps the compiled script next to it and --cache-dir <path> keeps it in a directory
+	struct Options
+	{
+		std::string LoadSnapshotPath;
+		std::string SaveSnapshotPath;
+		bool		IsCacheEnabled = false;
+		std::string CacheDirectory;
+		int			ScriptIndex = 1;
+	};
+
+	Options ParseOptions(int argc, char** argv)
+	{
+		Options options;
+
+		while (options.ScriptIndex + 1 < argc)
+		{
+			const std::string_view option(argv[options.ScriptIndex]);
+
+			if (option == "--cache")
+			{
+				options.IsCacheEnabled = true;
+				options.ScriptIndex += 1;
+				continue;
+			}
+
+			if (option == "--load-snapshot")
+				options.LoadSnapshotPath = argv[options.ScriptIndex + 1];
+			else if (option == "--save-snapshot")
+				options.SaveSnapshotPath = argv[options.ScriptIndex + 1];
+			else if (option == "--cache-dir")
+			{
+				options.IsCacheEnabled = true;
+				options.CacheDirectory = argv[options.ScriptIndex + 1];
+			}
+			else
+				break;
+
+			options.ScriptIndex += 2;
+		}
+
+		return options;
+	}
 }
 
 int main(int argc, char** argv)
 {
 	if (argc > 1)
 	{
-		const std::string_view scriptFileName(argv[1]);
+		const auto options = ParseOptions(argc, argv);
+
+		const std::string_view scriptFileName(argv[options.ScriptIndex]);
 		std::ifstream		   istream(scriptFileName.data());
 
 		if (istream)
 		{
 			try
 			{
-				Script().Run(istream);
+				Script script;
+
+				if (!options.LoadSnapshotPath.empty())
+					script.LoadSnapshot(options.LoadSnapshotPath);
+
+				if (options.IsCacheEnabled)
+					script.RunFile(std::string(scriptFileName), ScriptCache(options.CacheDirectory));
+				else
+					script.RunFile(std::string(scriptFileName));
+
+				if (!options.SaveSnapshotPath.empty())
+					script.SaveSnapshot(options.SaveSnapshotPath);
 			}
 			catch (const std::exception& ex)
 			{
@@ -56,10 +129,14 @@ int main(int argc, char** argv)
 		{
 			std::cout << "\n>> ";
 
-			std::string input;
-			if (!std::getline(std::cin, input))
+			std::cout.flush();
+
+			const auto line = script.ReadLine();
+			if (!line)
 				ProcessQuitCommand();
 
+			const auto& input = *line;
+
 			if (input.empty())
 				continue;
 
@@ -77,7 +154,7 @@ int main(int argc, char** argv)
 					continue;
 				}
 
-				const auto args = StringUtils::Split(input.substr(1));
+				const auto args = StringUtils::Split(std::string_view(input).substr(1));
 
 				const auto& command = args[0];
 				const auto	it = CommandHandlers.find(command);
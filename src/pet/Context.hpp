@@ -1,18 +1,65 @@
 #pragma once
 
+#include <pet/ModuleCache.hpp>
+
+#include <pet/runtime/InputReader.hpp>
+#include <pet/runtime/String.hpp>
+
+#include <toolkit/OutputBuffer.hpp>
 #include <toolkit/StringPool.hpp>
+#include <toolkit/ThreadPool.hpp>
+
+#include <iostream>
+
+#include <unistd.h>
 
 namespace pet
 {
 	class Context
 	{
 	private:
-		StringPool _identifierPool;
+		StringPool	 _identifierPool;
+		ModuleCache	 _modules;
+		InputReader	 _input;
+		OutputBuffer _output;
+
+		// Destroyed first: tasks nobody awaits may still be queued or running, and they use everything above
+		ThreadPool _threadPool;
 
 	public:
+		// Terminals see every printed line right away, redirected output is written in large chunks
+		Context() : _input(STDIN_FILENO), _output(std::cout, isatty(STDOUT_FILENO) ? FlushPolicy::Line : FlushPolicy::Size)
+		{
+		}
+
 		StringPool& GetIdentifierPool()
 		{
 			return _identifierPool;
 		}
+
+		StringInterner& GetStringInterner()
+		{
+			return StringInterner::GetInstance();
+		}
+
+		ModuleCache& GetModules()
+		{
+			return _modules;
+		}
+
+		ThreadPool& GetThreadPool()
+		{
+			return _threadPool;
+		}
+
+		InputReader& GetInput()
+		{
+			return _input;
+		}
+
+		OutputBuffer& GetOutput()
+		{
+			return _output;
+		}
 	};
 }
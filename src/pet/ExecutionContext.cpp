@@ -0,0 +1,34 @@
+#include <pet/ExecutionContext.hpp>
+
+#include <pet/runtime/Object.hpp>
+
+#include <toolkit/Profiler.hpp>
+#include <toolkit/ScopedInvoker.hpp>
+
+#include <mutex>
+
+namespace pet
+{
+	ExecutionContext::ExecutionContext(std::unique_ptr<Interpreter>&& interpreter) : _interpreter(std::move(interpreter))
+	{
+	}
+
+	void ExecutionContext::Run(const Program& program)
+	{
+		PET_PROFILE_DEBUG("ExecutionContext::Run()");
+
+		ScopedInvoker flushOutput(
+			[this]()
+			{
+				auto&				  output = _interpreter->GetContext().GetOutput();
+				const std::lock_guard lock(output.GetMutex());
+				output.Flush();
+			});
+
+		const auto ownerId = Object::SetCurrentOwnerId(_interpreter->GetId());
+		const ScopedInvoker restoreOwnerId([ownerId]() { Object::SetCurrentOwnerId(ownerId); });
+
+		_interpreter->ResetGlobalScope();
+		for (const auto& statement : program.GetStatements()) _interpreter->Execute(statement);
+	}
+}
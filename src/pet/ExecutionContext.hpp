@@ -0,0 +1,27 @@
+#pragma once
+
+#include <pet/Program.hpp>
+
+#include <pet/runtime/Interpreter.hpp>
+
+#include <memory>
+
+namespace pet
+{
+	// State of one thread running programs: an interpreter with a global scope of its own, which shares the builtins, the pools
+	// and the output of the script it was created from. Execution contexts of a script can run at the same time on different
+	// threads, each one on a single thread at a time.
+	class ExecutionContext
+	{
+		PET_NON_COPYABLE(ExecutionContext);
+
+	private:
+		std::unique_ptr<Interpreter> _interpreter;
+
+	public:
+		explicit ExecutionContext(std::unique_ptr<Interpreter>&& interpreter);
+
+		// Runs program from an empty global scope
+		void Run(const Program& program);
+	};
+}
@@ -1,5 +1,6 @@
 #include <pet/Expression.hpp>
 
+#include <pet/FunctionBody.hpp>
 #include <pet/Statement.hpp>
 
 #include <toolkit/StringJoiner.hpp>
@@ -94,8 +95,12 @@ namespace pet
 			sb % sj % "], body: [";
 		}
 
+		// Bodies left to a lazy parse are not parsed just to be printed
 		StringJoiner sj(" ");
-		for (const auto& statement : Body) sj % statement;
+		if (Body->IsParsed())
+			for (const auto& statement : Body->GetParsedStatements()) sj % statement;
+		else
+			sj % "...";
 
 		return sb % sj % " ] }";
 	}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <pet/parser/Token.hpp>
+#include <pet/runtime/Shape.hpp>
 #include <pet/runtime/Value.hpp>
 
 #include <toolkit/Macro.hpp>
@@ -58,6 +59,11 @@ namespace pet
 	struct Statement;
 	PET_DECLARE_UNIQ_PTR(Statement);
 
+	using StatementBlock = std::vector<StatementUniqPtr>;
+
+	class FunctionBody;
+	PET_DECLARE_PTR(FunctionBody);
+
 	struct Expression
 	{
 		virtual ~Expression() = default;
@@ -133,9 +139,9 @@ namespace pet
 
 	struct LiteralExpression final : public ExpressionBase<ExpressionKind::Literal>
 	{
-		pet::Value Value;
+		ValuePtr Value;
 
-		explicit LiteralExpression(pet::Value&& value) : Value(std::move(value))
+		explicit LiteralExpression(pet::Value&& value) : Value(std::make_shared<pet::Value>(std::move(value)))
 		{
 		}
 
@@ -177,6 +183,7 @@ namespace pet
 	{
 		ExpressionUniqPtr Target;
 		ExpressionUniqPtr Key;
+		InlineCache		  Cache;
 
 		MemberExpression(ExpressionUniqPtr&& target, ExpressionUniqPtr&& key) : Target(std::move(target)), Key(std::move(key))
 		{
@@ -192,11 +199,11 @@ namespace pet
 
 	struct FunctionExpression final : public ExpressionBase<ExpressionKind::Function>
 	{
-		std::vector<StringPoolId>	  Parameters;
-		std::vector<StatementUniqPtr> Body;
+		std::vector<StringPoolId> Parameters;
+		FunctionBodyPtr			  Body;
 
-		FunctionExpression(std::vector<StringPoolId>&& parameters, std::vector<StatementUniqPtr>&& body)
-			: Parameters(std::move(parameters)), Body(std::move(body))
+		FunctionExpression(std::vector<StringPoolId>&& parameters, const FunctionBodyPtr& body)
+			: Parameters(std::move(parameters)), Body(body)
 		{
 		}
 
@@ -0,0 +1,41 @@
+#include <pet/FunctionBody.hpp>
+
+#include <pet/parser/Parser.hpp>
+
+#include <mutex>
+#include <sstream>
+
+namespace pet
+{
+	namespace
+	{
+		// Functions may be invoked for the first time from several threads at once, and parsing adds to the identifier pool and the
+		// string interner of the context, which are not thread-safe
+		std::mutex ParseMutex;
+	}
+
+	FunctionBody::FunctionBody(StatementBlock&& statements) : _statements(std::move(statements)), _location{0, 0}, _isParsed(true)
+	{
+	}
+
+	FunctionBody::FunctionBody(std::string&& source, const Location& location)
+		: _source(std::move(source)), _location(location), _isParsed(false)
+	{
+	}
+
+	void FunctionBody::Parse(Context& context)
+	{
+		const std::lock_guard lock(ParseMutex);
+
+		if (IsParsed())
+			return;
+
+		std::istringstream stream(_source);
+		Parser			   parser(context, stream, true, _location);
+
+		_statements = parser.GetFunctionBody();
+		_source = std::string();
+
+		_isParsed.store(true, std::memory_order_release);
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <pet/Location.hpp>
+#include <pet/Statement.hpp>
+
+#include <atomic>
+
+namespace pet
+{
+	class Context;
+
+	// Statements of a function, shared by the AST and every closure created from it. A lazy parse only brace-matches bodies and
+	// keeps their source, which is parsed and folded the first time the function is invoked. Either way the statements are
+	// immutable once parsed.
+	class FunctionBody
+	{
+		PET_NON_COPYABLE(FunctionBody);
+
+	private:
+		StatementBlock	  _statements;
+		std::string		  _source;
+		Location		  _location;
+		std::atomic<bool> _isParsed;
+
+	public:
+		explicit FunctionBody(StatementBlock&& statements);
+
+		// source runs from just after the opening brace, which is at location, to the closing brace included
+		FunctionBody(std::string&& source, const Location& location);
+
+		bool IsParsed() const
+		{
+			return _isParsed.load(std::memory_order_acquire);
+		}
+
+		// Source of a body which is not parsed yet
+		const std::string& GetSource() const
+		{
+			return _source;
+		}
+
+		const Location& GetLocation() const
+		{
+			return _location;
+		}
+
+		// Parses the body with the identifier pool and the string interner of context on first use. Thread-safe.
+		const StatementBlock& GetStatements(Context& context)
+		{
+			if (!IsParsed())
+				Parse(context);
+
+			return _statements;
+		}
+
+		// The statements of a parsed body
+		const StatementBlock& GetParsedStatements() const
+		{
+			return _statements;
+		}
+
+	private:
+		void Parse(Context& context);
+	};
+}
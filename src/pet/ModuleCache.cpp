@@ -0,0 +1,171 @@
+#include <pet/ModuleCache.hpp>
+
+#include <pet/ScriptCache.hpp>
+
+#include <pet/parser/Parser.hpp>
+#include <pet/runtime/FileSystem.hpp>
+
+#include <toolkit/ScopedInvoker.hpp>
+#include <toolkit/StringUtils.hpp>
+
+#include <cstdlib>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+
+namespace pet
+{
+	namespace
+	{
+		thread_local ModuleCache::ImportChainPtr CurrentImportChain;
+
+		bool IsInImportChain(const ModuleCache::ImportChain* chain, const std::string& modulePath)
+		{
+			for (; chain; chain = chain->Parent.get())
+				if (chain->Path == modulePath)
+					return true;
+
+			return false;
+		}
+	}
+
+	ModuleCache::ModuleCache()
+	{
+		if (const auto searchPaths = std::getenv("PET_PATH"))
+			for (const auto directory : StringUtils::Split(searchPaths, ":"))
+				if (!directory.empty())
+					_searchPaths.emplace_back(directory);
+	}
+
+	void ModuleCache::SetScriptCache(const ScriptCache& cache)
+	{
+		_scriptCache = std::make_shared<const ScriptCache>(cache);
+	}
+
+	ScopePtr ModuleCache::Import(const std::string& path, const Scope& importer, Context& context, size_t ownerId, const Executor& execute)
+	{
+		std::unique_lock lock(_mutex);
+
+		const auto modulePath = Resolve(path, importer);
+
+		std::error_code error;
+		const auto		modificationTime = std::filesystem::last_write_time(modulePath, error);
+
+		// A module being loaded is waited for, unless its loading waits for this import. If the loading fails the module is gone,
+		// and this import tries again.
+		for (auto it = _modules.find(modulePath); it != _modules.end() && !it->second.IsLoaded; it = _modules.find(modulePath))
+		{
+			PET_CHECK(!IsWaitCircular(modulePath), RuntimeError(StringBuilder() % "Circular import of module '" % modulePath % "'"));
+
+			const auto			wait = _waits.insert(_waits.end(), Wait{CurrentImportChain, modulePath});
+			const ScopedInvoker si([this, wait]() { _waits.erase(wait); });
+
+			_loaded.wait(lock);
+		}
+
+		const auto it = _modules.find(modulePath);
+		if (it != _modules.end() && it->second.ModificationTime == modificationTime)
+			return it->second.Scope;
+
+		const auto scope = std::make_shared<Scope>(nullptr, ownerId);
+		_directories.insert_or_assign(scope.get(), std::make_pair(scope, std::filesystem::path(modulePath).parent_path()));
+
+		_modules.insert_or_assign(modulePath, Module{modificationTime, scope, false});
+
+		lock.unlock();
+
+		try
+		{
+			const auto importChain = SetImportChain(std::make_shared<ImportChain>(ImportChain{modulePath, CurrentImportChain}));
+			const ScopedInvoker si([&importChain]() { SetImportChain(importChain); });
+
+			execute(Compile(modulePath, context), scope);
+		}
+		catch (const std::exception& ex)
+		{
+			lock.lock();
+			_modules.erase(modulePath);
+			_loaded.notify_all();
+
+			PET_THROW(RuntimeError(StringBuilder() % "In module '" % modulePath % "': " % ex.what()));
+		}
+
+		lock.lock();
+		_modules.at(modulePath).IsLoaded = true;
+		_loaded.notify_all();
+
+		return scope;
+	}
+
+	ModuleCache::ImportChainPtr ModuleCache::GetImportChain()
+	{
+		return CurrentImportChain;
+	}
+
+	ModuleCache::ImportChainPtr ModuleCache::SetImportChain(ImportChainPtr chain)
+	{
+		return std::exchange(CurrentImportChain, std::move(chain));
+	}
+
+	bool ModuleCache::IsWaitCircular(const std::string& modulePath) const
+	{
+		// A module waits for the modules that threads loading it wait for. Those are followed from modulePath until one of them
+		// is in the current chain, which would then wait for itself.
+		std::vector<const std::string*>		 pending{&modulePath};
+		std::unordered_set<std::string_view> visited{modulePath};
+
+		while (!pending.empty())
+		{
+			const auto& path = *pending.back();
+			pending.pop_back();
+
+			if (IsInImportChain(CurrentImportChain.get(), path))
+				return true;
+
+			for (const auto& wait : _waits)
+				if (IsInImportChain(wait.Chain.get(), path) && visited.insert(wait.ModulePath).second)
+					pending.push_back(&wait.ModulePath);
+		}
+
+		return false;
+	}
+
+	std::string ModuleCache::Resolve(const std::string& path, const Scope& importer) const
+	{
+		const std::filesystem::path modulePath(path);
+
+		std::vector<std::filesystem::path> candidates;
+		if (modulePath.is_absolute())
+			candidates.push_back(modulePath);
+		else
+		{
+			const auto it = _directories.find(importer.GetOriginal());
+			candidates.push_back((it != _directories.end() ? it->second.second : _baseDirectory) / modulePath);
+
+			for (const auto& directory : _searchPaths) candidates.push_back(directory / modulePath);
+		}
+
+		for (const auto& candidate : candidates)
+		{
+			std::error_code error;
+			if (std::filesystem::is_regular_file(candidate, error))
+				return std::filesystem::canonical(candidate, error).string();
+		}
+
+		PET_THROW(RuntimeError(StringBuilder() % "Cannot find module '" % path % "'"));
+	}
+
+	StatementBlock ModuleCache::Compile(const std::string& path, Context& context) const
+	{
+		if (_scriptCache)
+			return _scriptCache->Load(path, context);
+
+		std::istringstream stream(FileSystem::ReadFile(path).ToString());
+		Parser			   parser(context, stream, true);
+
+		StatementBlock statements;
+		while (!parser.IsEndOfStream()) statements.emplace_back(parser.GetStatement());
+
+		return statements;
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <pet/Statement.hpp>
+
+#include <pet/runtime/Scope.hpp>
+
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pet
+{
+	class Context;
+	class ScriptCache;
+
+	// Modules imported by the scripts of a context. A module is parsed and executed in a scope of its own the first time it is
+	// imported, and every later import shares that scope, until the file is modified. The top-level code of a module runs without
+	// holding the cache, so it may start threads which import other modules. A thread importing a module another thread is
+	// loading waits for it, unless that loading waits, directly or through other modules, for a module the thread is loading:
+	// the import is then reported as circular instead of blocking both threads forever.
+	class ModuleCache
+	{
+		PET_NON_COPYABLE(ModuleCache);
+
+	public:
+		// Modules whose top-level code runs on the calling thread, innermost first. Parallel callbacks and tasks started by that
+		// code continue the chain, so that importing one of these modules from them is reported as circular instead of waiting
+		// for itself.
+		struct ImportChain
+		{
+			std::string						   Path;
+			std::shared_ptr<const ImportChain> Parent;
+		};
+		using ImportChainPtr = std::shared_ptr<const ImportChain>;
+
+	private:
+		struct Module
+		{
+			std::filesystem::file_time_type ModificationTime;
+			ScopePtr						Scope;
+			bool							IsLoaded;
+		};
+
+		// Import waiting for a module being loaded, with the chain of the thread waiting
+		struct Wait
+		{
+			ImportChainPtr Chain;
+			std::string	   ModulePath;
+		};
+
+	public:
+		using Executor = std::function<void(const StatementBlock& statements, const ScopePtr& scope)>;
+
+	private:
+		std::mutex				_mutex;
+		std::condition_variable _loaded;
+
+		std::unordered_map<std::string, Module> _modules;
+		std::list<Wait>							_waits;
+
+		// Directories of the files module scopes come from. Scopes replaced by a reload are kept, as functions may still use them.
+		std::unordered_map<const Scope*, std::pair<ScopePtr, std::filesystem::path>> _directories;
+
+		std::filesystem::path			   _baseDirectory;
+		std::vector<std::filesystem::path> _searchPaths;
+		std::shared_ptr<const ScriptCache> _scriptCache;
+
+	public:
+		// Search paths are read from PET_PATH, a list of directories separated by ':'
+		ModuleCache();
+
+		// Directory the paths imported by the main script are relative to, the current one if empty
+		void SetBaseDirectory(const std::filesystem::path& directory)
+		{
+			_baseDirectory = directory;
+		}
+
+		// Modules are compiled through cache instead of being parsed every time they are loaded
+		void SetScriptCache(const ScriptCache& cache);
+
+		// Returns the scope of the module at path, loading it with execute if needed. importer is the outermost scope of the code
+		// importing the module, which tells the directory relative paths start from.
+		ScopePtr Import(const std::string& path, const Scope& importer, Context& context, size_t ownerId, const Executor& execute);
+
+		static ImportChainPtr GetImportChain();
+
+		// Returns the previous chain, to be restored when the code continuing the chain is done
+		static ImportChainPtr SetImportChain(ImportChainPtr chain);
+
+	private:
+		// Whether waiting for modulePath would wait for a module the current chain is loading
+		bool IsWaitCircular(const std::string& modulePath) const;
+
+		// A relative path is looked up in the directory of the importer, or of the scope it is a copy of, then in the search paths
+		std::string Resolve(const std::string& path, const Scope& importer) const;
+
+		StatementBlock Compile(const std::string& path, Context& context) const;
+	};
+}
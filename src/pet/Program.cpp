@@ -0,0 +1,16 @@
+#include <pet/Program.hpp>
+
+#include <pet/parser/Parser.hpp>
+
+namespace pet
+{
+	ProgramConstPtr Program::Compile(Context& context, std::istream& stream)
+	{
+		Parser parser(context, stream, true);
+
+		StatementBlock statements;
+		while (!parser.IsEndOfStream()) statements.emplace_back(parser.GetStatement());
+
+		return std::make_shared<const Program>(std::move(statements));
+	}
+}
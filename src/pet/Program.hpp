@@ -0,0 +1,34 @@
+#pragma once
+
+#include <pet/Context.hpp>
+#include <pet/Statement.hpp>
+
+#include <istream>
+
+namespace pet
+{
+	class Program;
+	PET_DECLARE_PTR(Program);
+
+	// Top-level statements of a whole script, parsed and folded once. Running a program never changes it, and function bodies
+	// left to a lazy parse are parsed once under a lock, so one program can be run by execution contexts on several threads.
+	class Program
+	{
+		PET_NON_COPYABLE(Program);
+
+	private:
+		StatementBlock _statements;
+
+	public:
+		explicit Program(StatementBlock&& statements) : _statements(std::move(statements))
+		{
+		}
+
+		static ProgramConstPtr Compile(Context& context, std::istream& stream);
+
+		const StatementBlock& GetStatements() const
+		{
+			return _statements;
+		}
+	};
+}
@@ -1,11 +1,21 @@
 #include <pet/Script.hpp>
 
+#include <pet/ExecutionContext.hpp>
+#include <pet/Program.hpp>
+#include <pet/ScriptCache.hpp>
+
 #include <pet/parser/Parser.hpp>
 
+#include <pet/runtime/FileSystem.hpp>
 #include <pet/runtime/Interpreter.hpp>
 #include <pet/runtime/Globals.hpp>
+#include <pet/runtime/Snapshot.hpp>
 
 #include <toolkit/Profiler.hpp>
+#include <toolkit/ScopedInvoker.hpp>
+
+#include <filesystem>
+#include <fstream>
 
 namespace pet
 {
@@ -33,10 +43,82 @@ namespace pet
 		{
 			PET_PROFILE_DEBUG("Script::Run()");
 
-			Parser parser(_context, stream);
+			// Everything printed by the script goes out before the caller reports a result or an error
+			ScopedInvoker flushOutput([this]() { _context.GetOutput().Flush(); });
+
+			Parser parser(_context, stream, true);
 			while (!parser.IsEndOfStream()) _interpreter.Execute(parser.GetStatement());
 		}
 
+		void RunFile(const std::string& path)
+		{
+			std::ifstream stream(path);
+			PET_CHECK(stream, Exception(StringBuilder() % "IOError: Failed to open file '" % path % "'"));
+
+			_context.GetModules().SetBaseDirectory(std::filesystem::path(path).parent_path());
+			Run(stream);
+		}
+
+		void RunFile(const std::string& path, const ScriptCache& cache)
+		{
+			PET_PROFILE_DEBUG("Script::RunFile()");
+
+			ScopedInvoker flushOutput([this]() { _context.GetOutput().Flush(); });
+
+			_context.GetModules().SetBaseDirectory(std::filesystem::path(path).parent_path());
+			_context.GetModules().SetScriptCache(cache);
+
+			const auto statements = cache.Load(path, _context);
+			for (const auto& statement : statements) _interpreter.Execute(statement);
+		}
+
+		ProgramConstPtr Compile(std::istream& stream)
+		{
+			PET_PROFILE_DEBUG("Script::Compile()");
+
+			return Program::Compile(_context, stream);
+		}
+
+		std::unique_ptr<ExecutionContext> CreateExecutionContext()
+		{
+			return std::make_unique<ExecutionContext>(_interpreter.ForkInterpreter());
+		}
+
+		void SaveSnapshot(const std::string& path)
+		{
+			PET_PROFILE_DEBUG("Script::SaveSnapshot()");
+
+			std::string image;
+			Snapshot::Save(image, _interpreter.GetGlobalScope(), _interpreter.GetGlobals(), _context.GetIdentifierPool());
+
+			// Other processes may be loading the previous snapshot from a mapping, which truncating it would break
+			FileSystem::ReplaceFile(path, {image});
+		}
+
+		void LoadSnapshot(const std::string& path)
+		{
+			PET_PROFILE_DEBUG("Script::LoadSnapshot()");
+
+			_interpreter.SetGlobalScope(Snapshot::Load(FileSystem::MapFile(path), _context, _interpreter.GetGlobals()));
+		}
+
+		void SetFlushPolicy(FlushPolicy policy)
+		{
+			_context.GetOutput().SetFlushPolicy(policy);
+		}
+
+		std::optional<std::string> ReadLine()
+		{
+			auto& input = _context.GetInput();
+
+			std::lock_guard<std::mutex> lock(input.GetMutex());
+			const auto					line = input.ReadLine();
+			if (!line)
+				return std::nullopt;
+
+			return line->ToString();
+		}
+
 	private:
 		Globals RegisterGlobals(Context& context)
 		{
@@ -48,6 +130,24 @@ namespace pet
 
 			RegisterFunction(context, globals, std::make_shared<PrintFunction>());
 			RegisterFunction(context, globals, std::make_shared<ReadLnFunction>());
+			RegisterFunction(context, globals, std::make_shared<ReadLinesFunction>());
+			RegisterFunction(context, globals, std::make_shared<LinesFunction>());
+			RegisterFunction(context, globals, std::make_shared<ReadAllFunction>());
+			RegisterFunction(context, globals, std::make_shared<FlushFunction>());
+
+			RegisterFunction(context, globals, std::make_shared<ReadFileFunction>());
+			RegisterFunction(context, globals, std::make_shared<MapFileFunction>());
+			RegisterFunction(context, globals, std::make_shared<WriteFileFunction>());
+			RegisterFunction(context, globals, std::make_shared<AppendFileFunction>());
+
+			RegisterFunction(context, globals, std::make_shared<JsonParseFunction>());
+			RegisterFunction(context, globals, std::make_shared<JsonStringifyFunction>());
+
+			RegisterFunction(context, globals, std::make_shared<CsvParseFunction>());
+			RegisterFunction(context, globals, std::make_shared<CsvReadFunction>());
+
+			RegisterFunction(context, globals, std::make_shared<SerializeFunction>());
+			RegisterFunction(context, globals, std::make_shared<DeserializeFunction>());
 
 			RegisterFunction(context, globals, std::make_shared<TypeFunction>());
 			RegisterFunction(context, globals, std::make_shared<IntFunction>());
@@ -56,6 +156,41 @@ namespace pet
 
 			RegisterFunction(context, globals, std::make_shared<LenFunction>());
 
+			RegisterFunction(context, globals, std::make_shared<PushFunction>());
+			RegisterFunction(context, globals, std::make_shared<PopFunction>());
+			RegisterFunction(context, globals, std::make_shared<InsertFunction>());
+			RegisterFunction(context, globals, std::make_shared<RemoveFunction>());
+			RegisterFunction(context, globals, std::make_shared<ReserveFunction>());
+			RegisterFunction(context, globals, std::make_shared<ResizeFunction>());
+			RegisterFunction(context, globals, std::make_shared<CapacityFunction>());
+			RegisterFunction(context, globals, std::make_shared<SortFunction>());
+
+			RegisterFunction(context, globals, std::make_shared<FindFunction>());
+			RegisterFunction(context, globals, std::make_shared<SplitFunction>());
+			RegisterFunction(context, globals, std::make_shared<SubstrFunction>());
+			RegisterFunction(context, globals, std::make_shared<StartsWithFunction>());
+			RegisterFunction(context, globals, std::make_shared<EndsWithFunction>());
+			RegisterFunction(context, globals, std::make_shared<TrimFunction>());
+			RegisterFunction(context, globals, std::make_shared<JoinFunction>());
+
+			RegisterFunction(context, globals, std::make_shared<SumFunction>());
+			RegisterFunction(context, globals, std::make_shared<MinFunction>());
+			RegisterFunction(context, globals, std::make_shared<MaxFunction>());
+			RegisterFunction(context, globals, std::make_shared<DotFunction>());
+			RegisterFunction(context, globals, std::make_shared<CountFunction>());
+			RegisterFunction(context, globals, std::make_shared<AddFunction>());
+			RegisterFunction(context, globals, std::make_shared<MulFunction>());
+			RegisterFunction(context, globals, std::make_shared<PrefixSumFunction>());
+
+			RegisterFunction(context, globals, std::make_shared<ParallelMapFunction>());
+			RegisterFunction(context, globals, std::make_shared<ParallelFilterFunction>());
+			RegisterFunction(context, globals, std::make_shared<ParallelReduceFunction>());
+
+			RegisterFunction(context, globals, std::make_shared<SpawnFunction>());
+			RegisterFunction(context, globals, std::make_shared<AwaitFunction>());
+			RegisterFunction(context, globals, std::make_shared<AwaitAllFunction>());
+			RegisterFunction(context, globals, std::make_shared<SchedulerStatsFunction>());
+
 			return globals;
 		}
 	};
@@ -72,4 +207,44 @@ namespace pet
 	{
 		_impl->Run(istream);
 	}
+
+	void Script::RunFile(const std::string& path)
+	{
+		_impl->RunFile(path);
+	}
+
+	void Script::RunFile(const std::string& path, const ScriptCache& cache)
+	{
+		_impl->RunFile(path, cache);
+	}
+
+	std::shared_ptr<const Program> Script::Compile(std::istream& stream)
+	{
+		return _impl->Compile(stream);
+	}
+
+	std::unique_ptr<ExecutionContext> Script::CreateExecutionContext()
+	{
+		return _impl->CreateExecutionContext();
+	}
+
+	void Script::SaveSnapshot(const std::string& path)
+	{
+		_impl->SaveSnapshot(path);
+	}
+
+	void Script::LoadSnapshot(const std::string& path)
+	{
+		_impl->LoadSnapshot(path);
+	}
+
+	void Script::SetFlushPolicy(FlushPolicy policy)
+	{
+		_impl->SetFlushPolicy(policy);
+	}
+
+	std::optional<std::string> Script::ReadLine()
+	{
+		return _impl->ReadLine();
+	}
 }
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <toolkit/OutputBuffer.hpp>
+
 #include <istream>
 #include <memory>
+#include <optional>
+#include <string>
 
 namespace pet
 {
+	class ExecutionContext;
+	class Program;
+	class ScriptCache;
+
 	class Script
 	{
 		class Impl;
@@ -14,6 +22,31 @@ namespace pet
 		Script();
 		~Script();
 
+		// Modules imported by a script run from a stream are looked up from the current directory
 		void Run(std::istream& stream);
+
+		// Runs the script at path, whose modules are looked up from its directory
+		void RunFile(const std::string& path);
+
+		// Runs the script at path, whole, from the compiled form kept in cache if it is up to date. So are the modules it imports.
+		void RunFile(const std::string& path, const ScriptCache& cache);
+
+		// Parses a whole script once into a program which execution contexts created by this script can share
+		std::shared_ptr<const Program> Compile(std::istream& stream);
+
+		// Creates the state of one more thread running programs, see ExecutionContext
+		std::unique_ptr<ExecutionContext> CreateExecutionContext();
+
+		// Writes the global state left by the statements run so far to a file, see Snapshot
+		void SaveSnapshot(const std::string& path);
+
+		// Replaces the global state with the one saved in a file. The file is mapped and must not change while it is in use.
+		void LoadSnapshot(const std::string& path);
+
+		void SetFlushPolicy(FlushPolicy policy);
+
+		// Reads the next line of the standard input through the buffer readln() uses, so callers reading commands and
+		// scripts reading input consume the same stream. Returns nothing once the input is exhausted.
+		std::optional<std::string> ReadLine();
 	};
 }
@@ -0,0 +1,152 @@
+#include <pet/ScriptCache.hpp>
+
+#include <pet/parser/Parser.hpp>
+#include <pet/runtime/FileSystem.hpp>
+#include <pet/runtime/Serializer.hpp>
+#include <pet/runtime/Snapshot.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+
+namespace pet
+{
+	namespace
+	{
+		constexpr std::string_view Magic = "PETC";
+		constexpr std::string_view Version = PET_VERSION;
+
+		constexpr std::string_view SourceExtension = ".pet";
+		constexpr std::string_view EntryExtension = ".petc";
+
+		uint64_t Mix(uint64_t value)
+		{
+			value ^= value >> 33;
+			value *= 0xFF51AFD7ED558CCDull;
+			value ^= value >> 33;
+
+			return value;
+		}
+
+		// Hash of the source which stays the same across runs and builds, eight bytes at a time
+		uint64_t ComputeHash(std::string_view data)
+		{
+			constexpr uint64_t Multiplier = 0x9E3779B97F4A7C15ull;
+
+			auto hash = static_cast<uint64_t>(data.size()) * Multiplier;
+
+			size_t offset = 0;
+			for (; offset + sizeof(uint64_t) <= data.size(); offset += sizeof(uint64_t))
+			{
+				uint64_t chunk;
+				std::memcpy(&chunk, data.data() + offset, sizeof(chunk));
+
+				hash = (hash ^ Mix(chunk)) * Multiplier;
+			}
+
+			uint64_t tail = 0;
+			if (offset != data.size())
+				std::memcpy(&tail, data.data() + offset, data.size() - offset);
+
+			return Mix(hash ^ Mix(tail));
+		}
+
+		std::optional<StatementBlock> TryLoadEntry(const std::string& entryPath, const String& source, uint64_t hash, Context& context)
+		{
+			try
+			{
+				const auto entry = FileSystem::MapFile(entryPath);
+
+				SerialReader reader(entry, context.GetStringInterner(), "compiled script");
+				if (entry.GetView().substr(0, Magic.size()) != Magic)
+					return std::nullopt;
+
+				reader.ReadBytes(Magic.size());
+				if (reader.ReadString().GetView() != Version || reader.ReadVarint() != source.GetLength() || reader.ReadVarint() != hash)
+					return std::nullopt;
+
+				const auto offset = reader.GetOffset();
+				return Snapshot::LoadProgram(entry.Slice(offset, entry.GetLength() - offset), context);
+			}
+			catch (const std::exception&)
+			{
+				return std::nullopt;
+			}
+		}
+
+		// The entry is replaced rather than rewritten, so that concurrent runs never see a partial one
+		void TrySaveEntry(const std::string& entryPath, const String& source, uint64_t hash, const StatementBlock& statements,
+						  Context& context)
+		{
+			std::string entry;
+
+			{
+				SerialWriter writer(entry);
+				writer.WriteBytes(Magic.data(), Magic.size());
+				writer.WriteString(Version);
+				writer.WriteVarint(source.GetLength());
+				writer.WriteVarint(hash);
+			}
+
+			Snapshot::SaveProgram(entry, statements, context);
+
+			try
+			{
+				FileSystem::ReplaceFile(entryPath, {entry});
+			}
+			catch (const std::exception&)
+			{
+				// An entry that cannot be written only costs the next run a parse
+			}
+		}
+	}
+
+	ScriptCache::ScriptCache(std::string directory) : _directory(std::move(directory))
+	{
+		if (!_directory.empty())
+		{
+			std::error_code error;
+			std::filesystem::create_directories(_directory, error);
+		}
+	}
+
+	StatementBlock ScriptCache::Load(const std::string& path, Context& context) const
+	{
+		const auto source = FileSystem::ReadFile(path);
+		const auto hash = ComputeHash(source.GetView());
+		const auto entryPath = GetEntryPath(path, hash);
+
+		if (auto statements = TryLoadEntry(entryPath, source, hash, context))
+			return std::move(*statements);
+
+		// Bodies are parsed lazily as when running the source, so that one which is never called is never reported either. The
+		// entry gets them parsed, except those with errors.
+		std::istringstream stream(source.ToString());
+		Parser			   parser(context, stream, true);
+
+		StatementBlock statements;
+		while (!parser.IsEndOfStream()) statements.emplace_back(parser.GetStatement());
+
+		TrySaveEntry(entryPath, source, hash, statements, context);
+		return statements;
+	}
+
+	std::string ScriptCache::GetEntryPath(const std::string& path, uint64_t hash) const
+	{
+		if (_directory.empty())
+		{
+			const std::string_view pathView(path);
+			if (pathView.size() >= SourceExtension.size() && pathView.substr(pathView.size() - SourceExtension.size()) == SourceExtension)
+				return path + "c";
+
+			return path + std::string(EntryExtension);
+		}
+
+		std::ostringstream entryPath;
+		entryPath << _directory << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << EntryExtension;
+
+		return entryPath.str();
+	}
+}
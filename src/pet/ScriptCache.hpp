@@ -0,0 +1,29 @@
+#pragma once
+
+#include <pet/Context.hpp>
+#include <pet/Statement.hpp>
+
+#include <string>
+
+namespace pet
+{
+	// Compiled forms of script files, so that running an unchanged script again skips lexing, parsing and constant folding. An
+	// entry holds the folded AST of a whole script together with the version of pet and the size and hash of the source, and is
+	// only used while all of them match. Anything else, a corrupt entry included, is treated as a miss: the script is parsed and
+	// the entry is written again.
+	class ScriptCache
+	{
+	private:
+		std::string _directory;
+
+	public:
+		// Entries are named after the hash of the source in directory, or after the script itself next to it if directory is empty
+		explicit ScriptCache(std::string directory = std::string());
+
+		// Returns the top-level statements of the script at path. Failures to write the entry are ignored.
+		StatementBlock Load(const std::string& path, Context& context) const;
+
+	private:
+		std::string GetEntryPath(const std::string& path, uint64_t hash) const;
+	};
+}
@@ -1,5 +1,7 @@
 #include <pet/Statement.hpp>
 
+#include <pet/FunctionBody.hpp>
+
 #include <toolkit/StringJoiner.hpp>
 
 namespace pet
@@ -21,8 +23,12 @@ namespace pet
 			sb % sj % "], body: [";
 		}
 
+		// Bodies left to a lazy parse are not parsed just to be printed
 		StringJoiner sj(" ");
-		for (const auto& statement : Body) sj % statement;
+		if (Body->IsParsed())
+			for (const auto& statement : Body->GetParsedStatements()) sj % statement;
+		else
+			sj % "...";
 
 		return sb % sj % " ] }";
 	}
@@ -68,4 +74,9 @@ namespace pet
 	{
 		return StringBuilder() % "{ kind: " % GetKind() % " }";
 	}
+
+	std::string ImportStatement::ToString() const
+	{
+		return StringBuilder() % "{ kind: " % GetKind() % ", path: " % Path % " }";
+	}
 }
@@ -13,6 +13,7 @@ namespace pet
 	struct BreakStatement;
 	struct ReturnStatement;
 	struct ContinueStatement;
+	struct ImportStatement;
 
 	enum class StatementKind
 	{
@@ -24,7 +25,8 @@ namespace pet
 		While,
 		Break,
 		Return,
-		Continue
+		Continue,
+		Import
 	};
 
 	struct StatementVisitor
@@ -40,6 +42,7 @@ namespace pet
 		virtual void VisitBreak(BreakStatement& statement) = 0;
 		virtual void VisitReturn(ReturnStatement& statement) = 0;
 		virtual void VisitContinue(ContinueStatement& statement) = 0;
+		virtual void VisitImport(ImportStatement& statement) = 0;
 	};
 
 	struct Statement
@@ -84,12 +87,12 @@ namespace pet
 
 	struct FunctionDeclarationStatement final : public StatementBase<StatementKind::FunctionDeclaration>
 	{
-		StringPoolId				  Id;
-		std::vector<StringPoolId>	  Parameters;
-		std::vector<StatementUniqPtr> Body;
+		StringPoolId			  Id;
+		std::vector<StringPoolId> Parameters;
+		FunctionBodyPtr			  Body;
 
-		FunctionDeclarationStatement(StringPoolId id, std::vector<StringPoolId>&& parameters, std::vector<StatementUniqPtr>&& body)
-			: Id(id), Parameters(std::move(parameters)), Body(std::move(body))
+		FunctionDeclarationStatement(StringPoolId id, std::vector<StringPoolId>&& parameters, const FunctionBodyPtr& body)
+			: Id(id), Parameters(std::move(parameters)), Body(body)
 		{
 		}
 
@@ -204,4 +207,21 @@ namespace pet
 
 		std::string ToString() const override;
 	};
+
+	// Declares the top-level variables and functions of a module as constants of the current scope
+	struct ImportStatement final : public StatementBase<StatementKind::Import>
+	{
+		std::string Path;
+
+		explicit ImportStatement(std::string&& path) : Path(std::move(path))
+		{
+		}
+
+		void Visit(StatementVisitor& visitor) override
+		{
+			visitor.VisitImport(*this);
+		}
+
+		std::string ToString() const override;
+	};
 }
@@ -2,8 +2,6 @@
 
 #include <pet/Statement.hpp>
 
-#include <toolkit/StringUtils.hpp>
-
 #include <cmath>
 
 namespace pet
@@ -88,7 +86,7 @@ namespace pet
 					return Value(leftValue.AsFloat() + rightValue.AsFloat());
 			}
 			else if (leftValue.IsString() && rightValue.IsString())
-				return Value(StringUtils::Concat(leftValue.AsString(), rightValue.AsString()));
+				return Value(leftValue.AsString().Concat(rightValue.AsString()));
 
 			break;
 		}
@@ -257,7 +255,7 @@ namespace pet
 		switch (expression->GetKind())
 		{
 		case ExpressionKind::Literal:
-			return static_cast<LiteralExpression*>(expression.get())->Value;
+			return *static_cast<LiteralExpression*>(expression.get())->Value;
 		case ExpressionKind::Binary:
 		{
 			const auto binaryExpression = static_cast<BinaryExpression*>(expression.get());
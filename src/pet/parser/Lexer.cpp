@@ -16,14 +16,14 @@ namespace pet
 				{"and", TokenKind::And},	 {"break", TokenKind::Break},	{"continue", TokenKind::Continue}, {"else", TokenKind::Else},
 				{"if", TokenKind::If},		 {"false", TokenKind::False},	{"fun", TokenKind::Fun},		   {"null", TokenKind::Null},
 				{"or", TokenKind::Or},		 {"return", TokenKind::Return}, {"true", TokenKind::True},		   {"var", TokenKind::Var},
-				{"while", TokenKind::While}, {"const", TokenKind::Const}};
+				{"while", TokenKind::While}, {"const", TokenKind::Const},	{"import", TokenKind::Import}};
 
 			const auto it = KeywordsToTokenKinds.find(keyword);
 			return it != KeywordsToTokenKinds.end() ? it->second : defaultType;
 		}
 	}
 
-	Lexer::Lexer(std::istream& stream) : _stream(stream), _location{1, 0}, _buffer(ReadToken())
+	Lexer::Lexer(std::istream& stream, const Location& location) : _stream(stream), _location(location), _buffer(ReadToken())
 	{
 	}
 
@@ -34,6 +34,64 @@ namespace pet
 		return result;
 	}
 
+	std::string Lexer::SkipBlock()
+	{
+		PET_CHECK(_buffer.Kind == TokenKind::LeftBrace, LogicException());
+
+		std::string result;
+		size_t		depth = 1;
+		char		ch;
+
+		// Lines are counted as in SkipWhitespaces, which does not see the newlines inside strings
+		while (depth != 0 && TryReadChar(ch))
+		{
+			result += ch;
+
+			switch (ch)
+			{
+			case '{':
+				++depth;
+				break;
+			case '}':
+				--depth;
+				break;
+			case '\n':
+				++_location.Line;
+				_location.Column = 0;
+				break;
+			case '#':
+				while (TryReadChar(ch) && ch != '\n') result += ch;
+
+				if (_stream)
+				{
+					result += ch;
+					++_location.Line;
+					_location.Column = 0;
+				}
+				break;
+			case '"':
+				while (TryReadChar(ch))
+				{
+					result += ch;
+
+					if (ch == '"')
+						break;
+
+					if (ch == '\\' && TryReadChar(ch))
+						result += ch;
+				}
+				break;
+			default:
+				break;
+			}
+		}
+
+		PET_CHECK(depth == 0, SyntaxError(_location, "Expect '}' after block"));
+
+		_buffer = ReadToken();
+		return result;
+	}
+
 	std::string Lexer::ReadIdentifier()
 	{
 		std::string result;
@@ -41,7 +99,7 @@ namespace pet
 
 		while (TryReadChar(ch))
 		{
-			if (!result.empty() ? std::isalnum(ch) : std::isalpha(ch))
+			if (ch == '_' || (!result.empty() ? std::isalnum(ch) : std::isalpha(ch)))
 				result += ch;
 			else
 			{
@@ -211,7 +269,7 @@ namespace pet
 		{
 			PutCharBack();
 
-			if (std::isalpha(ch))
+			if (std::isalpha(ch) || ch == '_')
 			{
 				auto	   identifier = ReadIdentifier();
 				const auto tokenKind = GetTokenKindFromKeyword(identifier);
@@ -16,7 +16,7 @@ namespace pet
 		Token		  _buffer;
 
 	public:
-		explicit Lexer(std::istream& stream);
+		explicit Lexer(std::istream& stream, const Location& location = Location{1, 0});
 
 		const Location& GetLocation() const
 		{
@@ -35,6 +35,10 @@ namespace pet
 
 		Token GetToken();
 
+		// Skips the block opened by the current token '{' up to the matching '}', and returns its source after the opening brace.
+		// Only strings and comments are recognized on the way, so the block is not checked for invalid tokens.
+		std::string SkipBlock();
+
 	private:
 		std::string ReadIdentifier();
 		Token		ReadNumber();
@@ -3,10 +3,14 @@
 #include <pet/parser/ConstantFolder.hpp>
 
 #include <pet/Error.hpp>
+#include <pet/FunctionBody.hpp>
+
+#include <toolkit/NumberUtils.hpp>
 
 namespace pet
 {
-	Parser::Parser(Context& context, std::istream& stream) : _context(context), _lexer(stream)
+	Parser::Parser(Context& context, std::istream& stream, bool isLazy, const Location& location)
+		: _context(context), _lexer(stream, location), _isLazy(isLazy)
 	{
 	}
 
@@ -15,6 +19,14 @@ namespace pet
 		return _lexer.IsEndOfStream() ? nullptr : ParseStatement();
 	}
 
+	StatementBlock Parser::GetFunctionBody()
+	{
+		auto result = ParseBlock();
+		PET_CHECK(_lexer.IsEndOfStream(), SyntaxError(_lexer.GetLocation(), "Unexpected token after function body"));
+
+		return result;
+	}
+
 	StatementUniqPtr Parser::ParseStatement()
 	{
 		const auto tokenKind = _lexer.PeekToken().Kind;
@@ -43,6 +55,9 @@ namespace pet
 		case TokenKind::Continue:
 			_lexer.GetToken();
 			return ParseContinueStatement();
+		case TokenKind::Import:
+			_lexer.GetToken();
+			return ParseImportStatement();
 		default:
 			return ParseExpressionStatement();
 		}
@@ -88,11 +103,8 @@ namespace pet
 
 		PET_CHECK(TryGetToken(TokenKind::RightParenthesis), SyntaxError(_lexer.GetLocation(), "Expect ')' after function parameter list"));
 
-		PET_CHECK(TryGetToken(TokenKind::LeftBrace), SyntaxError(_lexer.GetLocation(), "Expect '{' before function body"));
-		auto body = ParseBlock();
-
 		return std::make_unique<FunctionDeclarationStatement>(_context.GetIdentifierPool().Add(std::move(nameToken.Value)),
-															  std::move(parameters), std::move(body));
+															  std::move(parameters), ParseFunctionBody());
 	}
 
 	StatementUniqPtr Parser::ParseIfStatement()
@@ -139,6 +151,15 @@ namespace pet
 		return std::make_unique<ContinueStatement>();
 	}
 
+	StatementUniqPtr Parser::ParseImportStatement()
+	{
+		Token pathToken;
+		PET_CHECK(TryGetToken(pathToken, TokenKind::String), SyntaxError(_lexer.GetLocation(), "Expect module path after 'import'"));
+		PET_CHECK(TryGetToken(TokenKind::Semicolon), SyntaxError(_lexer.GetLocation(), "Expect ';' after module path"));
+
+		return std::make_unique<ImportStatement>(std::move(pathToken.Value));
+	}
+
 	StatementUniqPtr Parser::ParseExpressionStatement()
 	{
 		if (TryGetToken(TokenKind::LeftBrace))
@@ -165,6 +186,20 @@ namespace pet
 		PET_THROW(SyntaxError(_lexer.GetLocation(), "Expect '}' after block"));
 	}
 
+	FunctionBodyPtr Parser::ParseFunctionBody()
+	{
+		PET_CHECK(_lexer.PeekToken().Kind == TokenKind::LeftBrace, SyntaxError(_lexer.GetLocation(), "Expect '{' before function body"));
+
+		if (_isLazy)
+		{
+			const auto location = _lexer.GetLocation();
+			return std::make_shared<FunctionBody>(_lexer.SkipBlock(), location);
+		}
+
+		_lexer.GetToken();
+		return std::make_shared<FunctionBody>(ParseBlock());
+	}
+
 	ExpressionUniqPtr Parser::ParseExpression()
 	{
 		return ParseAssignment();
@@ -340,8 +375,8 @@ namespace pet
 				auto nameToken = _lexer.GetToken();
 				PET_CHECK(nameToken.Kind == TokenKind::Identifier, SyntaxError(_lexer.GetLocation(), "Expect property name after '.'"));
 
-				result = std::make_unique<MemberExpression>(std::move(result),
-															std::make_unique<LiteralExpression>(Value(std::move(nameToken.Value))));
+				result = std::make_unique<MemberExpression>(
+					std::move(result), std::make_unique<LiteralExpression>(Value(_context.GetStringInterner().Intern(nameToken.Value))));
 			}
 			else if (TryGetToken(TokenKind::LeftBracket))
 			{
@@ -405,13 +440,23 @@ namespace pet
 		}
 
 		if (TryGetToken(token, TokenKind::Integer))
-			return std::make_unique<LiteralExpression>(Value(std::stoll(token.Value)));
+		{
+			const auto value = NumberUtils::Parse<ValueIntegerType>(token.Value);
+			PET_CHECK(value, SyntaxError(_lexer.GetLocation(), StringBuilder() % "Integer literal '" % token.Value % "' is out of range"));
+
+			return std::make_unique<LiteralExpression>(Value(*value));
+		}
 
 		if (TryGetToken(token, TokenKind::Number))
-			return std::make_unique<LiteralExpression>(Value(std::stod(token.Value)));
+		{
+			const auto value = NumberUtils::Parse<ValueFloatType>(token.Value);
+			PET_CHECK(value, SyntaxError(_lexer.GetLocation(), StringBuilder() % "Invalid number literal '" % token.Value % "'"));
+
+			return std::make_unique<LiteralExpression>(Value(*value));
+		}
 
 		if (TryGetToken(token, TokenKind::String))
-			return std::make_unique<LiteralExpression>(Value(std::move(token.Value)));
+			return std::make_unique<LiteralExpression>(Value(_context.GetStringInterner().Intern(token.Value)));
 
 		if (TryGetToken(token, TokenKind::Identifier))
 			return std::make_unique<IdentifierExpression>(_context.GetIdentifierPool().Add(std::move(token.Value)));
@@ -434,10 +479,7 @@ namespace pet
 			PET_CHECK(TryGetToken(TokenKind::RightParenthesis),
 					  SyntaxError(_lexer.GetLocation(), "Expect ')' after function parameter list"));
 
-			PET_CHECK(TryGetToken(TokenKind::LeftBrace), SyntaxError(_lexer.GetLocation(), "Expect '{' before function body"));
-			auto body = ParseBlock();
-
-			return std::make_unique<FunctionExpression>(std::move(parameters), std::move(body));
+			return std::make_unique<FunctionExpression>(std::move(parameters), ParseFunctionBody());
 		}
 
 		PET_THROW(TypeError(_lexer.GetLocation(), StringBuilder() % "Expect expression, got '" % _lexer.PeekToken().Kind % "'"));
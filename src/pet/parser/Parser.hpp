@@ -15,11 +15,13 @@ namespace pet
 		PET_NON_COPYABLE(Parser);
 
 	private:
-		Context& _context;
-		Lexer	 _lexer;
+		Context&   _context;
+		Lexer	   _lexer;
+		const bool _isLazy;
 
 	public:
-		Parser(Context& context, std::istream& stream);
+		// A lazy parser leaves function bodies to FunctionBody, which parses them on first use. location is where stream starts.
+		Parser(Context& context, std::istream& stream, bool isLazy = false, const Location& location = Location{1, 0});
 
 		bool IsEndOfStream() const
 		{
@@ -28,6 +30,9 @@ namespace pet
 
 		StatementUniqPtr GetStatement();
 
+		// Parses the rest of a function body, the stream starting just after its opening brace
+		StatementBlock GetFunctionBody();
+
 	private:
 		StatementUniqPtr ParseStatement();
 		StatementUniqPtr ParseVariableDeclarationStatement(bool isConst);
@@ -37,9 +42,11 @@ namespace pet
 		StatementUniqPtr ParseBreakStatement();
 		StatementUniqPtr ParseReturnStatement();
 		StatementUniqPtr ParseContinueStatement();
+		StatementUniqPtr ParseImportStatement();
 		StatementUniqPtr ParseExpressionStatement();
 
 		std::vector<StatementUniqPtr> ParseBlock();
+		FunctionBodyPtr				  ParseFunctionBody();
 		ExpressionUniqPtr			  ParseExpression();
 		ExpressionUniqPtr			  ParseAssignment();
 		ExpressionUniqPtr			  ParseOr();
@@ -46,6 +46,7 @@ namespace pet
 		Continue,
 		Else,
 		If,
+		Import,
 		False,
 		Fun,
 		Null,
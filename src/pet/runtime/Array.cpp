@@ -1,22 +1,154 @@
 #include <pet/runtime/Array.hpp>
 
 #include <pet/Error.hpp>
+#include <pet/runtime/ValueKey.hpp>
+#include <pet/runtime/ValueWriter.hpp>
 
-#include <toolkit/StringJoiner.hpp>
+#include <toolkit/Sort.hpp>
+
+#include <cmath>
 
 namespace pet
 {
-	Array::Array(std::vector<ValuePtr>&& values) : _values(std::move(values))
+	namespace
+	{
+		template <typename T>
+		using ElementType = typename std::decay_t<T>::value_type;
+
+		template <typename T>
+		bool CanStore(const Value& value)
+		{
+			if constexpr (std::is_same_v<ValueIntegerType, T>)
+				return value.IsInteger();
+			else if constexpr (std::is_same_v<ValueFloatType, T>)
+				return value.IsFloat();
+			else
+				return true;
+		}
+
+		template <typename T>
+		T Unbox(const ValuePtr& value)
+		{
+			if constexpr (std::is_same_v<ValueIntegerType, T>)
+				return value->AsInteger();
+			else if constexpr (std::is_same_v<ValueFloatType, T>)
+				return std::get<ValueFloatType>(*value);
+			else
+				return value;
+		}
+
+		ValuePtr Box(const ValuePtr& value)
+		{
+			return value;
+		}
+
+		ValuePtr Box(ValueIntegerType value)
+		{
+			return MakeIntegerValue(value);
+		}
+
+		ValuePtr Box(ValueFloatType value)
+		{
+			return std::make_shared<Value>(value);
+		}
+
+		template <typename T>
+		std::vector<T> UnboxAll(const std::vector<ValuePtr>& values)
+		{
+			std::vector<T> result;
+			result.reserve(values.size());
+
+			for (const auto& value : values) result.push_back(Unbox<T>(value));
+
+			return result;
+		}
+
+		template <typename T>
+		bool CanStoreAll(const std::vector<ValuePtr>& values)
+		{
+			for (const auto& value : values)
+				if (!CanStore<T>(*value))
+					return false;
+
+			return !values.empty();
+		}
+
+		// Doubles from 2^63 up are beyond every integer
+		constexpr ValueFloatType IntegerLimit = 9223372036854775808.0;
+
+		// Compares an integer and a float exactly, where converting the integer to a float would round it above 2^53
+		bool IsLess(ValueIntegerType left, ValueFloatType right)
+		{
+			if (std::isnan(right) || right < -IntegerLimit)
+				return false;
+
+			if (right >= IntegerLimit)
+				return true;
+
+			const auto truncated = std::trunc(right);
+			const auto integer = static_cast<ValueIntegerType>(truncated);
+
+			return left < integer || (left == integer && truncated < right);
+		}
+
+		bool IsLess(ValueFloatType left, ValueIntegerType right)
+		{
+			if (std::isnan(left) || left >= IntegerLimit)
+				return false;
+
+			if (left < -IntegerLimit)
+				return true;
+
+			const auto truncated = std::trunc(left);
+			const auto integer = static_cast<ValueIntegerType>(truncated);
+
+			return integer < right || (integer == right && left < truncated);
+		}
+
+		bool IsNumberLess(const ValuePtr& left, const ValuePtr& right)
+		{
+			if (left->IsInteger())
+				return right->IsInteger() ? left->AsInteger() < right->AsInteger() : IsLess(left->AsInteger(), right->AsFloat());
+
+			return right->IsInteger() ? IsLess(left->AsFloat(), right->AsInteger()) : left->AsFloat() < right->AsFloat();
+		}
+
+		ArrayStorage MakeStorage(std::vector<ValuePtr>&& values)
+		{
+			if (CanStoreAll<ValueIntegerType>(values))
+				return UnboxAll<ValueIntegerType>(values);
+
+			if (CanStoreAll<ValueFloatType>(values))
+				return UnboxAll<ValueFloatType>(values);
+
+			return std::move(values);
+		}
+	}
+
+	Array::Array(std::vector<ValuePtr>&& values) : _storage(MakeStorage(std::move(values))), _hash(0)
+	{
+	}
+
+	Array::Array(std::vector<ValueIntegerType>&& values) : _storage(std::move(values)), _hash(0)
+	{
+	}
+
+	Array::Array(std::vector<ValueFloatType>&& values) : _storage(std::move(values)), _hash(0)
 	{
 	}
 
 	void Array::Set(const ValuePtr& key, const ValuePtr& value)
 	{
+		CheckIsWritable("array");
+
 		PET_CHECK(key->IsInteger(), RuntimeError(StringBuilder() % "Invalid array index '" % key % "'"));
 
 		const auto index = key->AsInteger();
-		PET_CHECK(index >= 0 && index < static_cast<ValueIntegerType>(_values.size()), OutOfRangeError(index, _values.size()));
-		_values[static_cast<size_t>(index)] = value;
+		PET_CHECK(index >= 0 && index < GetLength(), OutOfRangeError(index, GetLength()));
+
+		PrepareStorage(*value);
+		std::visit([&](auto& values) { values[static_cast<size_t>(index)] = Unbox<ElementType<decltype(values)>>(value); }, _storage);
+		_hash.store(0, std::memory_order_relaxed);
 	}
 
 	ValuePtr Array::Get(const ValuePtr& key) const
@@ -27,24 +159,269 @@ namespace pet
 
 	ValuePtr Array::Get(ValueIntegerType index) const
 	{
-		PET_CHECK(index >= 0 && index < static_cast<ValueIntegerType>(_values.size()), OutOfRangeError(index, _values.size()));
-		return _values[static_cast<size_t>(index)];
+		PET_CHECK(index >= 0 && index < GetLength(), OutOfRangeError(index, GetLength()));
+		return std::visit([index](const auto& values) { return Box(values[static_cast<size_t>(index)]); }, _storage);
+	}
+
+	bool Array::TryGetNumber(const Value& key, Value& element) const
+	{
+		if (std::holds_alternative<std::vector<ValuePtr>>(_storage))
+			return false;
+
+		PET_CHECK(key.IsInteger(), RuntimeError(StringBuilder() % "Invalid array index '" % key % "'"));
+
+		const auto index = key.AsInteger();
+		PET_CHECK(index >= 0 && index < GetLength(), OutOfRangeError(index, GetLength()));
+
+		if (const auto integers = std::get_if<std::vector<ValueIntegerType>>(&_storage))
+			element = (*integers)[static_cast<size_t>(index)];
+		else
+			element = std::get<std::vector<ValueFloatType>>(_storage)[static_cast<size_t>(index)];
+
+		return true;
 	}
 
 	ValueIntegerType Array::GetLength() const
 	{
-		return static_cast<ValueIntegerType>(_values.size());
+		return std::visit([](const auto& values) { return static_cast<ValueIntegerType>(values.size()); }, _storage);
+	}
+
+	ValueIntegerType Array::GetCapacity() const
+	{
+		return std::visit([](const auto& values) { return static_cast<ValueIntegerType>(values.capacity()); }, _storage);
+	}
+
+	void Array::Push(const ValuePtr& value)
+	{
+		CheckIsWritable("array");
+
+		PrepareStorage(*value);
+		std::visit([&](auto& values) { values.push_back(Unbox<ElementType<decltype(values)>>(value)); }, _storage);
+		_hash.store(0, std::memory_order_relaxed);
+	}
+
+	ValuePtr Array::Pop()
+	{
+		CheckIsWritable("array");
+
+		PET_CHECK(GetLength() != 0, RuntimeError("Array is empty"));
+
+		_hash.store(0, std::memory_order_relaxed);
+
+		return std::visit(
+			[](auto& values)
+			{
+				auto result = Box(values.back());
+				values.pop_back();
+				return result;
+			},
+			_storage);
+	}
+
+	void Array::Insert(ValueIntegerType index, const ValuePtr& value)
+	{
+		CheckIsWritable("array");
+
+		PET_CHECK(index >= 0 && index <= GetLength(), OutOfRangeError(index, GetLength() + 1));
+
+		PrepareStorage(*value);
+		std::visit([&](auto& values) { values.insert(values.begin() + index, Unbox<ElementType<decltype(values)>>(value)); }, _storage);
+		_hash.store(0, std::memory_order_relaxed);
+	}
+
+	ValuePtr Array::Remove(ValueIntegerType index)
+	{
+		CheckIsWritable("array");
+
+		PET_CHECK(index >= 0 && index < GetLength(), OutOfRangeError(index, GetLength()));
+
+		_hash.store(0, std::memory_order_relaxed);
+
+		return std::visit(
+			[index](auto& values)
+			{
+				auto result = Box(values[static_cast<size_t>(index)]);
+				values.erase(values.begin() + index);
+				return result;
+			},
+			_storage);
+	}
+
+	void Array::Reserve(ValueIntegerType capacity)
+	{
+		CheckIsWritable("array");
+
+		PET_CHECK(capacity >= 0, RuntimeError(StringBuilder() % "Invalid array capacity " % capacity));
+		std::visit([capacity](auto& values) { values.reserve(static_cast<size_t>(capacity)); }, _storage);
+	}
+
+	void Array::Resize(ValueIntegerType length)
+	{
+		CheckIsWritable("array");
+
+		PET_CHECK(length >= 0, RuntimeError(StringBuilder() % "Invalid array length " % length));
+
+		// Padding is null, which only generic storage can hold
+		if (length > GetLength())
+			PrepareStorage(*NullValue);
+
+		std::visit(
+			[length](auto& values)
+			{
+				if constexpr (std::is_same_v<ValuePtr, ElementType<decltype(values)>>)
+					values.resize(static_cast<size_t>(length), NullValue);
+				else
+					values.resize(static_cast<size_t>(length));
+			},
+			_storage);
+		_hash.store(0, std::memory_order_relaxed);
+	}
+
+	void Array::Assign(std::vector<ValuePtr>&& values)
+	{
+		CheckIsWritable("array");
+
+		_storage = MakeStorage(std::move(values));
+		_hash.store(0, std::memory_order_relaxed);
+	}
+
+	void Array::Sort()
+	{
+		CheckIsWritable("array");
+
+		// Radix sort wins over comparison sorts from a few hundred elements
+		constexpr size_t MinRadixSortSize = 256;
+
+		if (auto integers = std::get_if<std::vector<ValueIntegerType>>(&_storage))
+		{
+			if (integers->size() >= MinRadixSortSize)
+				RadixSort(integers->data(), integers->size());
+			else
+				PdqSort(integers->begin(), integers->end(), std::less<>());
+		}
+		else if (auto floats = std::get_if<std::vector<ValueFloatType>>(&_storage))
+			PdqSort(floats->begin(), floats->end(), std::less<>());
+		else
+		{
+			auto& values = std::get<std::vector<ValuePtr>>(_storage);
+
+			const auto isString = [](const ValuePtr& value) { return value->IsString(); };
+			const auto isNumber = [](const ValuePtr& value) { return value->IsNumber(); };
+
+			const auto isStringLess = [](const ValuePtr& left, const ValuePtr& right)
+			{ return left->AsString().GetView() < right->AsString().GetView(); };
+
+			if (std::all_of(values.begin(), values.end(), isString))
+				PdqSort(values.begin(), values.end(), isStringLess);
+			else if (std::all_of(values.begin(), values.end(), isNumber))
+				PdqSort(values.begin(), values.end(), IsNumberLess);
+			else
+				PET_THROW(RuntimeError("Only arrays of numbers or of strings can be sorted without a comparator"));
+		}
+
+		_hash.store(0, std::memory_order_relaxed);
+	}
+
+	void Array::Sort(const std::function<bool(const ValuePtr&, const ValuePtr&)>& isLess)
+	{
+		CheckIsWritable("array");
+
+		std::vector<ValuePtr> values;
+		values.reserve(static_cast<size_t>(GetLength()));
+
+		std::visit(
+			[&values](const auto& storage)
+			{
+				for (const auto& value : storage) values.push_back(Box(value));
+			},
+			_storage);
+
+		PdqSort(values.begin(), values.end(), isLess);
+
+		// Every element has the same type as before, so typed storage stays typed
+		_storage = MakeStorage(std::move(values));
+		_hash.store(0, std::memory_order_relaxed);
+	}
+
+	size_t Array::GetHash() const
+	{
+		if (const auto hash = _hash.load(std::memory_order_relaxed); hash != 0)
+			return hash;
+
+		const ValueKeyHasher hasher;
+
+		auto result = static_cast<size_t>(GetLength());
+		auto isFlat = true;
+
+		std::visit(
+			[&](const auto& values)
+			{
+				for (const auto& value : values)
+				{
+					if constexpr (std::is_same_v<ValuePtr, ElementType<decltype(values)>>)
+					{
+						result = ValueKeyHasher::Combine(result, hasher(*value));
+						isFlat = isFlat && !value->IsArray();
+					}
+					else
+						result = ValueKeyHasher::Combine(result, hasher(Value(value)));
+				}
+			},
+			_storage);
+
+		result = result != 0 ? result : 1;
+
+		// Nested arrays can change without this one noticing, so only flat arrays keep the hash
+		if (isFlat)
+			_hash.store(result, std::memory_order_relaxed);
+
+		return result;
 	}
 
 	std::string Array::ToString() const
 	{
-		StringBuilder sb;
+		std::string result;
+		ValueWriter<std::string>(result).Write(*this);
+
+		return result;
+	}
+
+	void Array::PrepareStorage(const Value& value)
+	{
+		const auto canStore = std::visit([&value](const auto& values) { return CanStore<ElementType<decltype(values)>>(value); }, _storage);
+		if (canStore && (GetLength() != 0 || _storage.index() != 0 || !value.IsNumber()))
+			return;
+
+		// An empty array takes the type of its first element, keeping the reserved capacity
+		if (GetLength() == 0)
+		{
+			const auto capacity = static_cast<size_t>(GetCapacity());
+
+			if (value.IsInteger())
+				_storage = std::vector<ValueIntegerType>();
+			else if (value.IsFloat())
+				_storage = std::vector<ValueFloatType>();
+			else
+				_storage = std::vector<ValuePtr>();
 
-		sb % "[ ";
-		StringJoiner sj;
+			std::visit([capacity](auto& values) { values.reserve(capacity); }, _storage);
+		}
+		else
+			ConvertToGeneric();
+	}
+
+	void Array::ConvertToGeneric()
+	{
+		std::vector<ValuePtr> result;
+		result.reserve(static_cast<size_t>(GetCapacity()));
 
-		for (const auto& value : _values) sj % value;
+		std::visit(
+			[&result](const auto& values)
+			{
+				for (const auto& value : values) result.push_back(Box(value));
+			},
+			_storage);
 
-		return sb % sj % (sj.IsEmpty() ? "" : " ") % "]";
+		_storage = std::move(result);
 	}
 }
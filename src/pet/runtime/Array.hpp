@@ -2,24 +2,76 @@
 
 #include <pet/runtime/Object.hpp>
 
+#include <atomic>
+#include <functional>
+
 namespace pet
 {
+	// Homogeneous integer and float arrays are stored unboxed, anything else holds a vector of values
+	using ArrayStorage = std::variant<std::vector<ValuePtr>, std::vector<ValueIntegerType>, std::vector<ValueFloatType>>;
+
 	class Array final : public Object
 	{
 	private:
-		std::vector<ValuePtr> _values;
+		ArrayStorage _storage;
+
+		// Arrays shared by threads may be hashed by several of them at once, which all store the same value
+		mutable std::atomic<size_t> _hash;
 
 	public:
 		explicit Array(std::vector<ValuePtr>&& values);
+		explicit Array(std::vector<ValueIntegerType>&& values);
+		explicit Array(std::vector<ValueFloatType>&& values);
 
 		void	 Set(const ValuePtr& key, const ValuePtr& value) override;
 		ValuePtr Get(const ValuePtr& key) const override;
 
 		ValuePtr Get(ValueIntegerType index) const;
 
+		// Reads the element at key into element without boxing it if the array stores numbers unboxed, returns false otherwise
+		bool TryGetNumber(const Value& key, Value& element) const;
+
 		ValueIntegerType GetLength() const;
+		ValueIntegerType GetCapacity() const;
+
+		void	 Push(const ValuePtr& value);
+		ValuePtr Pop();
+		void	 Insert(ValueIntegerType index, const ValuePtr& value);
+		ValuePtr Remove(ValueIntegerType index);
+
+		void Reserve(ValueIntegerType capacity);
+		void Resize(ValueIntegerType length);
+
+		// Replaces all elements, which are stored unboxed if they allow it
+		void Assign(std::vector<ValuePtr>&& values);
+
+		// Sorts numbers in ascending order and strings by bytes, other element types need a comparator
+		void Sort();
+
+		// Sorts with a function telling whether its first argument goes before the second one. The array is only modified if the
+		// comparator succeeds for every pair, and changes the comparator makes to the array are lost.
+		void Sort(const std::function<bool(const ValuePtr&, const ValuePtr&)>& isLess);
+
+		const ArrayStorage& GetStorage() const
+		{
+			return _storage;
+		}
+
+		// Returns the unboxed elements if the array is currently stored as a vector of T
+		template <typename T>
+		const std::vector<T>* TryGetValues() const
+		{
+			return std::get_if<std::vector<T>>(&_storage);
+		}
+
+		// Structural hash for use as a dictionary key, cached for flat arrays until they are modified
+		size_t GetHash() const;
 
 		std::string ToString() const;
+
+	private:
+		void PrepareStorage(const Value& value);
+		void ConvertToGeneric();
 	};
 	PET_DECLARE_PTR(Array);
 }
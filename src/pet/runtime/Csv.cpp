@@ -0,0 +1,543 @@
+#include <pet/runtime/Csv.hpp>
+
+#include <pet/Error.hpp>
+#include <pet/runtime/Array.hpp>
+#include <pet/runtime/Dictionary.hpp>
+
+#include <toolkit/ScopedInvoker.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <unordered_set>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace pet
+{
+	namespace
+	{
+		constexpr char Quote = '"';
+
+		// Chunks are large enough for thread hand-off to be negligible, and there are a few per thread to balance the load
+		constexpr size_t MinChunkSize = 1 << 20;
+		constexpr size_t ChunksPerThread = 4;
+
+		struct Field
+		{
+			size_t Offset;
+			size_t Length;
+			bool   IsQuoted;
+		};
+
+		// Ordered from the narrowest to the widest type, a column has the widest kind of its fields
+		enum class FieldKind
+		{
+			Empty,
+			Integer,
+			Float,
+			String
+		};
+
+		struct ColumnType
+		{
+			FieldKind Kind = FieldKind::Empty;
+			bool	  HasNulls = false;
+
+			void Merge(const ColumnType& other)
+			{
+				Kind = std::max(Kind, other.Kind);
+				HasNulls = HasNulls || other.HasNulls;
+			}
+		};
+
+		struct Chunk
+		{
+			size_t Begin = 0;
+			size_t End = 0;
+
+			std::vector<ColumnType> Columns;
+			size_t					FirstRow = 0;
+			size_t					RowCount = 0;
+		};
+
+		// Calls func(position) for every delimiter, newline and quote of [begin, end) in order
+		template <typename F>
+		void ForEachSpecial(const char* begin, const char* end, char delimiter, F&& func)
+		{
+			auto current = begin;
+
+#ifdef __SSE2__
+			const auto delimiters = _mm_set1_epi8(delimiter);
+			const auto newlines = _mm_set1_epi8('\n');
+			const auto quotes = _mm_set1_epi8(Quote);
+
+			for (; end - current >= 16; current += 16)
+			{
+				const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+				const auto special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, delimiters), _mm_cmpeq_epi8(block, newlines)),
+												  _mm_cmpeq_epi8(block, quotes));
+
+				for (auto mask = static_cast<unsigned>(_mm_movemask_epi8(special)); mask != 0; mask &= mask - 1)
+					func(current + __builtin_ctz(mask));
+			}
+#endif
+
+			for (; current != end; ++current)
+				if (*current == delimiter || *current == '\n' || *current == Quote)
+					func(current);
+		}
+
+		size_t CountQuotes(const char* begin, const char* end)
+		{
+			size_t result = 0;
+			auto   current = begin;
+
+#ifdef __SSE2__
+			const auto quotes = _mm_set1_epi8(Quote);
+
+			for (; end - current >= 16; current += 16)
+			{
+				const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+				result += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, quotes)))));
+			}
+#endif
+
+			return result + static_cast<size_t>(std::count(current, end, Quote));
+		}
+
+		// Returns the offset following the first record end of [begin, end), knowing whether begin is inside a quoted field
+		size_t FindRecordEnd(const char* text, size_t begin, size_t end, bool isInQuotes)
+		{
+			for (auto offset = begin; offset != end; ++offset)
+			{
+				if (text[offset] == Quote)
+					isInQuotes = !isInQuotes;
+				else if (text[offset] == '\n' && !isInQuotes)
+					return offset + 1;
+			}
+
+			return end;
+		}
+
+		FieldKind Classify(std::string_view field)
+		{
+			if (field.empty())
+				return FieldKind::Empty;
+
+			// from_chars also reads "inf" and "nan", which are strings here
+			const auto first = field.front();
+			if (first != '-' && first != '.' && (first < '0' || first > '9'))
+				return FieldKind::String;
+
+			const auto end = field.data() + field.size();
+
+			ValueIntegerType integer;
+			if (const auto [position, error] = std::from_chars(field.data(), end, integer); error == std::errc() && position == end)
+				return FieldKind::Integer;
+
+			ValueFloatType number;
+			if (const auto [position, error] = std::from_chars(field.data(), end, number); error == std::errc() && position == end)
+				return FieldKind::Float;
+
+			return FieldKind::String;
+		}
+
+		template <typename T>
+		T ParseNumber(std::string_view field)
+		{
+			T result = 0;
+			std::from_chars(field.data(), field.data() + field.size(), result);
+			return result;
+		}
+
+		class Reader
+		{
+		private:
+			const String&	  _text;
+			const char*		  _data;
+			const CsvOptions& _options;
+			ThreadPool&		  _threadPool;
+
+			std::vector<Chunk>		_chunks;
+			std::vector<ColumnType> _columns;
+			size_t					_rowCount;
+
+		public:
+			Reader(const String& text, const CsvOptions& options, ThreadPool& threadPool)
+				: _text(text), _data(text.GetView().data()), _options(options), _threadPool(threadPool), _rowCount(0)
+			{
+			}
+
+			ValuePtr Read(StringInterner& interner)
+			{
+				auto begin = size_t(0);
+				std::vector<String> names;
+
+				if (_options.HasHeader)
+				{
+					auto  hasHeader = false;
+					Chunk header;
+
+					while (begin != _text.GetLength() && !hasHeader)
+					{
+						header.Begin = begin;
+						header.End = begin = FindRecordEnd(_data, begin, _text.GetLength(), false);
+
+						Tokenize(header,
+								 [&](const std::vector<Field>& fields)
+								 {
+									 for (const auto& field : fields) names.push_back(GetString(field));
+									 hasHeader = true;
+								 });
+					}
+
+					std::unordered_set<std::string_view> uniqueNames;
+					for (const auto& name : names)
+						PET_CHECK(uniqueNames.insert(name.GetView()).second,
+								  RuntimeError(StringBuilder() % "Duplicate CSV column '" % name.GetView() % "'"));
+				}
+
+				// Records share the shape of the header, whose keys are then interned. Without a shape they take hash mode.
+				Shape* shape = nullptr;
+				if (!names.empty() && names.size() <= Dictionary::MaxShapeSize)
+				{
+					shape = Shape::GetRoot();
+					for (size_t i = 0; i < names.size() && shape; ++i) shape = shape->AddDataTransition(names[i].GetView(), interner);
+
+					if (shape)
+						names = shape->GetKeys();
+				}
+
+				Split(begin);
+
+				_threadPool.ParallelFor(_chunks.size(),
+										[this, columnCount = names.size()](size_t chunk)
+										{
+											Infer(_chunks[chunk], columnCount);
+										});
+
+				MergeColumns(names.size());
+
+				if (_options.AsColumns)
+					return ReadColumns(names, shape);
+
+				return ReadRows(names, shape);
+			}
+
+		private:
+			// Cuts [begin, size) in chunks of whole records. A quote toggles between quoted and unquoted text and an escaped quote
+			// toggles twice, so the parity of the quotes preceding a chunk tells whether it starts inside a quoted field.
+			void Split(size_t begin)
+			{
+				const auto size = _text.GetLength() - begin;
+				const auto threadCount = _threadPool.GetThreadCount();
+				const auto maxChunkCount = threadCount != 0 ? (threadCount + 1) * ChunksPerThread : 1;
+				const auto chunkCount = std::clamp<size_t>(size / MinChunkSize, 1, maxChunkCount);
+
+				std::vector<size_t> bounds(chunkCount + 1);
+				for (size_t i = 0; i <= chunkCount; ++i) bounds[i] = begin + size / chunkCount * i;
+				bounds.back() = _text.GetLength();
+
+				std::vector<size_t> quoteCounts(chunkCount);
+				_threadPool.ParallelFor(chunkCount,
+										[&](size_t i) { quoteCounts[i] = CountQuotes(_data + bounds[i], _data + bounds[i + 1]); });
+
+				std::vector<bool> startsInQuotes(chunkCount);
+				for (size_t i = 1; i < chunkCount; ++i) startsInQuotes[i] = startsInQuotes[i - 1] != (quoteCounts[i - 1] % 2 == 1);
+
+				const auto end = bounds.back();
+				_threadPool.ParallelFor(chunkCount - 1,
+										[&](size_t i) { bounds[i + 1] = FindRecordEnd(_data, bounds[i + 1], end, startsInQuotes[i + 1]); });
+
+				_chunks.resize(chunkCount);
+				for (size_t i = 0; i < chunkCount; ++i)
+				{
+					// A quoted field longer than a chunk pushes the next bounds beyond the following ones
+					_chunks[i].Begin = i == 0 ? bounds[0] : _chunks[i - 1].End;
+					_chunks[i].End = std::max(bounds[i + 1], _chunks[i].Begin);
+				}
+			}
+
+			// Calls onRecord(fields) for every record of the chunk. Nothing is kept between records, so a chunk is tokenized once
+			// to infer column types and once more to convert its fields.
+			template <typename F>
+			void Tokenize(const Chunk& chunk, F&& onRecord) const
+			{
+				const auto delimiter = _options.Delimiter;
+
+				std::vector<Field> fields;
+
+				auto fieldBegin = chunk.Begin;
+				auto isInQuotes = false;
+
+				const auto addField = [&](size_t end)
+				{ fields.push_back(Field{fieldBegin, end - fieldBegin, end != fieldBegin && _data[fieldBegin] == Quote}); };
+
+				const auto endRecord = [&](size_t end)
+				{
+					if (end != fieldBegin && _data[end - 1] == '\r')
+						--end;
+
+					// Blank lines are not records
+					if (!fields.empty() || end != fieldBegin)
+					{
+						addField(end);
+						onRecord(std::as_const(fields));
+						fields.clear();
+					}
+				};
+
+				ForEachSpecial(_data + chunk.Begin, _data + chunk.End, delimiter,
+							   [&](const char* position)
+							   {
+								   const auto offset = static_cast<size_t>(position - _data);
+
+								   if (*position == Quote)
+									   isInQuotes = !isInQuotes;
+								   else if (isInQuotes)
+									   return;
+								   else if (*position == delimiter)
+								   {
+									   addField(offset);
+									   fieldBegin = offset + 1;
+								   }
+								   else
+								   {
+									   endRecord(offset);
+									   fieldBegin = offset + 1;
+								   }
+							   });
+
+				PET_CHECK(!isInQuotes, RuntimeError("Unterminated quoted CSV field"));
+
+				// The last record of the text may not end with a newline
+				if (fieldBegin != chunk.End || !fields.empty())
+					endRecord(chunk.End);
+			}
+
+			void Infer(Chunk& chunk, size_t columnCount) const
+			{
+				chunk.Columns.resize(columnCount);
+
+				Tokenize(chunk,
+						 [&](const std::vector<Field>& fields)
+						 {
+							 if (_options.HasHeader)
+								 PET_CHECK(fields.size() <= columnCount,
+										   RuntimeError(StringBuilder() % "CSV record with " % fields.size() % " fields, the header has " %
+														columnCount % " columns"));
+							 else if (fields.size() > chunk.Columns.size())
+							 {
+								 // Columns appearing now were missing from the previous rows
+								 chunk.Columns.resize(fields.size(), ColumnType{FieldKind::Empty, chunk.RowCount != 0});
+							 }
+
+							 for (size_t i = 0; i < fields.size(); ++i)
+							 {
+								 const auto kind = fields[i].IsQuoted ? FieldKind::String : Classify(GetView(fields[i]));
+								 chunk.Columns[i].Merge(ColumnType{kind, kind == FieldKind::Empty});
+							 }
+
+							 for (auto i = fields.size(); i < chunk.Columns.size(); ++i) chunk.Columns[i].HasNulls = true;
+
+							 ++chunk.RowCount;
+						 });
+			}
+
+			void MergeColumns(size_t columnCount)
+			{
+				for (const auto& chunk : _chunks) columnCount = std::max(columnCount, chunk.Columns.size());
+
+				_columns.resize(columnCount);
+
+				for (auto& chunk : _chunks)
+				{
+					chunk.FirstRow = _rowCount;
+					_rowCount += chunk.RowCount;
+
+					for (size_t i = 0; i < columnCount; ++i)
+						if (i < chunk.Columns.size())
+							_columns[i].Merge(chunk.Columns[i]);
+						else if (chunk.RowCount != 0)
+							_columns[i].HasNulls = true;
+				}
+			}
+
+			ValuePtr ReadColumns(const std::vector<String>& names, Shape* shape)
+			{
+				std::vector<ArrayStorage> columns;
+				columns.reserve(_columns.size());
+
+				for (const auto& column : _columns)
+					if (!column.HasNulls && column.Kind == FieldKind::Integer)
+						columns.emplace_back(std::vector<ValueIntegerType>(_rowCount));
+					else if (!column.HasNulls && column.Kind == FieldKind::Float)
+						columns.emplace_back(std::vector<ValueFloatType>(_rowCount));
+					else
+						columns.emplace_back(std::vector<ValuePtr>(_rowCount));
+
+				_threadPool.ParallelFor(_chunks.size(),
+										[&](size_t index)
+										{
+											auto row = _chunks[index].FirstRow;
+											Tokenize(_chunks[index],
+													 [&](const std::vector<Field>& fields)
+													 {
+														 for (size_t i = 0; i < columns.size(); ++i)
+															 SetColumnValue(columns[i], row, i < fields.size() ? &fields[i] : nullptr, i);
+
+														 ++row;
+													 });
+										});
+
+				std::vector<ValuePtr> arrays;
+				arrays.reserve(columns.size());
+
+				const auto makeArray = [](auto& values) { return std::make_shared<Value>(std::make_shared<Array>(std::move(values))); };
+				for (auto& column : columns) arrays.push_back(std::visit(makeArray, column));
+
+				if (!_options.HasHeader)
+					return std::make_shared<Value>(std::make_shared<Array>(std::move(arrays)));
+
+				if (shape)
+					return std::make_shared<Value>(std::make_shared<Dictionary>(shape, std::move(arrays)));
+
+				auto result = std::make_shared<Dictionary>();
+				result->Reserve(names.size());
+
+				for (size_t i = 0; i < names.size(); ++i) result->Set(std::make_shared<Value>(names[i]), arrays[i]);
+
+				return std::make_shared<Value>(std::move(result));
+			}
+
+			void SetColumnValue(ArrayStorage& column, size_t row, const Field* field, size_t index) const
+			{
+				std::visit(
+					[&](auto& values)
+					{
+						using T = typename std::decay_t<decltype(values)>::value_type;
+
+						if constexpr (std::is_same_v<T, ValuePtr>)
+							values[row] = MakeValue(field, _columns[index].Kind);
+						else
+							values[row] = ParseNumber<T>(GetView(*field));
+					},
+					column);
+			}
+
+			// Complete rows share the shape of the header, the others are built key by key without their null fields
+			ValuePtr ReadRows(const std::vector<String>& names, Shape* shape)
+			{
+				std::vector<ValuePtr> keys;
+				keys.reserve(names.size());
+
+				for (const auto& name : names) keys.push_back(std::make_shared<Value>(name));
+
+				std::vector<ValuePtr> rows(_rowCount);
+
+				// Rows built by the threads of the pool belong to the interpreter reading the file
+				const auto ownerId = Object::GetCurrentOwnerId();
+
+				_threadPool.ParallelFor(_chunks.size(),
+										[&](size_t index)
+										{
+											const auto previousOwnerId = Object::SetCurrentOwnerId(ownerId);
+											const ScopedInvoker si([previousOwnerId]() { Object::SetCurrentOwnerId(previousOwnerId); });
+
+											auto row = _chunks[index].FirstRow;
+											Tokenize(_chunks[index],
+													 [&](const std::vector<Field>& fields) { rows[row++] = MakeRow(fields, keys, shape); });
+										});
+
+				return std::make_shared<Value>(std::make_shared<Array>(std::move(rows)));
+			}
+
+			ValuePtr MakeRow(const std::vector<Field>& fields, const std::vector<ValuePtr>& keys, Shape* shape) const
+			{
+				std::vector<ValuePtr> values(_columns.size());
+				auto				  isComplete = fields.size() == _columns.size();
+
+				for (size_t i = 0; i < values.size(); ++i)
+				{
+					values[i] = MakeValue(i < fields.size() ? &fields[i] : nullptr, _columns[i].Kind);
+					isComplete = isComplete && !values[i]->IsNull();
+				}
+
+				if (!_options.HasHeader)
+					return std::make_shared<Value>(std::make_shared<Array>(std::move(values)));
+
+				if (shape && isComplete)
+					return std::make_shared<Value>(std::make_shared<Dictionary>(shape, std::move(values)));
+
+				auto dictionary = std::make_shared<Dictionary>();
+				dictionary->Reserve(keys.size());
+
+				for (size_t i = 0; i < keys.size(); ++i) dictionary->Set(keys[i], values[i]);
+
+				return std::make_shared<Value>(std::move(dictionary));
+			}
+
+			ValuePtr MakeValue(const Field* field, FieldKind kind) const
+			{
+				if (!field || (!field->IsQuoted && field->Length == 0))
+					return NullValue;
+
+				switch (kind)
+				{
+				case FieldKind::Integer:
+					return std::make_shared<Value>(ParseNumber<ValueIntegerType>(GetView(*field)));
+				case FieldKind::Float:
+					return std::make_shared<Value>(ParseNumber<ValueFloatType>(GetView(*field)));
+				case FieldKind::String:
+					return std::make_shared<Value>(GetString(*field));
+				case FieldKind::Empty:
+				default:
+					return NullValue;
+				}
+			}
+
+			std::string_view GetView(const Field& field) const
+			{
+				return std::string_view(_data + field.Offset, field.Length);
+			}
+
+			String GetString(const Field& field) const
+			{
+				if (!field.IsQuoted)
+					return _text.Slice(field.Offset, field.Length);
+
+				const auto view = GetView(field);
+				if (view.size() >= 2 && view.back() == Quote && view.find(Quote, 1) == view.size() - 1)
+					return _text.Slice(field.Offset + 1, field.Length - 2);
+
+				// Quotes open and close quoted text, a doubled quote inside quoted text is a quote
+				std::string result;
+				result.reserve(view.size());
+
+				auto isInQuotes = false;
+				for (size_t i = 0; i < view.size(); ++i)
+				{
+					if (view[i] != Quote)
+						result.push_back(view[i]);
+					else if (isInQuotes && i + 1 < view.size() && view[i + 1] == Quote)
+						result.push_back(view[i++]);
+					else
+						isInQuotes = !isInQuotes;
+				}
+
+				return String(result);
+			}
+		};
+	}
+
+	ValuePtr Csv::Read(const String& text, const CsvOptions& options, StringInterner& interner, ThreadPool& threadPool)
+	{
+		PET_CHECK(options.Delimiter != Quote && options.Delimiter != '\n' && options.Delimiter != '\r',
+				  RuntimeError(StringBuilder() % "Invalid CSV delimiter '" % options.Delimiter % "'"));
+
+		return Reader(text, options, threadPool).Read(interner);
+	}
+}
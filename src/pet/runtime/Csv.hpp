@@ -0,0 +1,31 @@
+#pragma once
+
+#include <pet/runtime/Value.hpp>
+
+#include <toolkit/ThreadPool.hpp>
+
+namespace pet
+{
+	struct CsvOptions
+	{
+		char Delimiter = ',';
+
+		// The first record names the columns
+		bool HasHeader = true;
+
+		// Returns columns instead of rows: numeric columns without missing fields are stored as unboxed arrays
+		bool AsColumns = false;
+	};
+
+	// RFC 4180 CSV: fields may be quoted, "" is a quote inside a quoted field, records end with LF or CRLF and blank lines are
+	// skipped. Every column gets the widest type of its unquoted fields (integer, then float, then string); quoted fields are
+	// strings and empty unquoted fields are null.
+	// With a header, rows are dictionaries and columns are a dictionary of arrays, both keyed by column name. Without one,
+	// rows and columns are arrays.
+	struct Csv
+	{
+		// The text is split into chunks at record boundaries, which are tokenized and converted in parallel. Strings are slices of
+		// text unless they contain escaped quotes.
+		static ValuePtr Read(const String& text, const CsvOptions& options, StringInterner& interner, ThreadPool& threadPool);
+	};
+}
@@ -1,39 +1,140 @@
 #include <pet/runtime/Dictionary.hpp>
 
 #include <pet/Error.hpp>
+#include <pet/runtime/ValueWriter.hpp>
 
 #include <toolkit/Macro.hpp>
-#include <toolkit/StringJoiner.hpp>
 
 namespace pet
 {
+	Dictionary::Dictionary() : _shape(Shape::GetRoot())
+	{
+	}
+
+	Dictionary::Dictionary(Shape* shape, std::vector<ValuePtr>&& slots) : _shape(shape), _slots(std::move(slots))
+	{
+	}
+
 	void Dictionary::Set(const ValuePtr& key, const ValuePtr& value)
 	{
-		PET_CHECK(key->IsString(), RuntimeError(StringBuilder() % "Invalid dictionary key '" % key % "'"));
+		CheckIsWritable("dictionary");
+
+		PET_CHECK(ValueKey::IsValid(*key), RuntimeError(StringBuilder() % "Invalid dictionary key '" % key % "'"));
+
+		if (_shape && !key->IsString())
+			ConvertToHashMode();
+
+		if (_shape)
+		{
+			const auto& keyString = key->AsString();
+
+			if (const auto slot = _shape->Find(keyString))
+			{
+				if (!value->IsNull())
+				{
+					_slots[*slot] = value;
+					return;
+				}
+			}
+			else if (value->IsNull())
+				return;
+			else if (keyString.IsInterned() && _shape->GetSize() < MaxShapeSize)
+			{
+				_shape = _shape->AddTransition(keyString);
+				_slots.emplace_back(value);
+				return;
+			}
+
+			ConvertToHashMode();
+		}
 
 		if (value->IsNull())
-			_properties.erase(key->AsString());
+			_properties.Erase(*key);
+		else if (const auto property = _properties.Find(*key))
+			*property = value;
 		else
-			_properties.insert_or_assign(key->AsString(), value);
+			_properties.InsertOrAssign(ValueKey::Freeze(*key), value);
 	}
 
 	ValuePtr Dictionary::Get(const ValuePtr& key) const
 	{
-		PET_CHECK(key->IsString(), RuntimeError(StringBuilder() % "Invalid dictionary key '" % key % "'"));
+		PET_CHECK(ValueKey::IsValid(*key), RuntimeError(StringBuilder() % "Invalid dictionary key '" % key % "'"));
 
-		const auto it = _properties.find(key->AsString());
-		return it != _properties.end() ? it->second : NullValue;
+		if (_shape)
+		{
+			const auto slot = key->IsString() ? _shape->Find(key->AsString()) : std::nullopt;
+			return slot ? _slots[*slot] : NullValue;
+		}
+
+		const auto value = _properties.Find(*key);
+		return value ? *value : NullValue;
+	}
+
+	void Dictionary::Set(const ValuePtr& key, const ValuePtr& value, InlineCache& cache)
+	{
+		CheckIsWritable("dictionary");
+
+		if (_shape && !value->IsNull())
+		{
+			if (const auto slot = cache.Find(_shape))
+			{
+				_slots[*slot] = value;
+				return;
+			}
+		}
+
+		Set(key, value);
+
+		if (_shape && key->IsString())
+			if (const auto slot = _shape->Find(key->AsString()))
+				cache.Add(_shape, *slot);
+	}
+
+	ValuePtr Dictionary::Get(const ValuePtr& key, InlineCache& cache) const
+	{
+		if (!_shape || !key->IsString())
+			return Get(key);
+
+		if (const auto slot = cache.Find(_shape))
+			return _slots[*slot];
+
+		const auto slot = _shape->Find(key->AsString());
+		if (!slot)
+			return NullValue;
+
+		cache.Add(_shape, *slot);
+		return _slots[*slot];
+	}
+
+	void Dictionary::Reserve(size_t size)
+	{
+		CheckIsWritable("dictionary");
+
+		if (_shape && size > MaxShapeSize)
+			ConvertToHashMode();
+
+		if (_shape)
+			_slots.reserve(size);
+		else
+			_properties.Reserve(size);
 	}
 
 	std::string Dictionary::ToString() const
 	{
-		StringBuilder sb;
+		std::string result;
+		ValueWriter<std::string>(result).Write(*this);
+
+		return result;
+	}
 
-		sb % "{ ";
-		StringJoiner sj;
+	void Dictionary::ConvertToHashMode()
+	{
+		const auto& keys = _shape->GetKeys();
 
-		for (const auto& [key, value] : _properties) sj % (StringBuilder() % key % ": " % value->ToString());
+		_properties.Reserve(keys.size());
+		for (size_t i = 0; i < keys.size(); ++i) _properties.InsertOrAssign(Value(keys[i]), std::move(_slots[i]));
 
-		return sb % sj % (sj.IsEmpty() ? "" : " ") % "}";
+		_shape = nullptr;
+		_slots = std::vector<ValuePtr>();
 	}
 }
@@ -1,20 +1,62 @@
 #pragma once
 
 #include <pet/runtime/Object.hpp>
+#include <pet/runtime/Shape.hpp>
+#include <pet/runtime/ValueKey.hpp>
 
-#include <unordered_map>
+#include <toolkit/FlatHashMap.hpp>
 
 namespace pet
 {
 	class Dictionary final : public Object
 	{
+	public:
+		static constexpr size_t MaxShapeSize = 32;
+
 	private:
-		std::unordered_map<std::string, ValuePtr> _properties;
+		// Record-like dictionaries keep interned keys in a shared shape and values in slots, the rest fall back to hash mode
+		Shape*				  _shape;
+		std::vector<ValuePtr> _slots;
+
+		FlatHashMap<Value, ValuePtr, ValueKeyHasher, ValueKeyEqual> _properties;
 
 	public:
+		Dictionary();
+
+		// Builds a record holding slots, one non-null value per key of shape
+		Dictionary(Shape* shape, std::vector<ValuePtr>&& slots);
+
 		void	 Set(const ValuePtr& key, const ValuePtr& value) override;
 		ValuePtr Get(const ValuePtr& key) const override;
 
+		void	 Set(const ValuePtr& key, const ValuePtr& value, InlineCache& cache);
+		ValuePtr Get(const ValuePtr& key, InlineCache& cache) const;
+
+		// Prepares for size entries. Dictionaries which cannot stay in shape mode with that many go to hash mode right away.
+		void Reserve(size_t size);
+
+		// The shape of a record, or nullptr in hash mode
+		Shape* GetShape() const
+		{
+			return _shape;
+		}
+
+		// Calls func(key, value) for every entry in insertion order. Keys are Strings in shape mode and Values in hash mode.
+		template <typename F>
+		void ForEach(F&& func) const
+		{
+			if (_shape)
+			{
+				const auto& keys = _shape->GetKeys();
+				for (size_t i = 0; i < keys.size(); ++i) func(keys[i], _slots[i]);
+			}
+			else
+				for (const auto& [key, value] : _properties) func(key, value);
+		}
+
 		std::string ToString() const;
+
+	private:
+		void ConvertToHashMode();
 	};
 }
@@ -0,0 +1,263 @@
+#include <pet/runtime/FileSystem.hpp>
+
+#include <pet/Error.hpp>
+
+#include <toolkit/ScopedInvoker.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace pet
+{
+	namespace
+	{
+		constexpr size_t ReadChunkSize = 256 * 1024;
+
+		RuntimeError MakeFileError(std::string_view action, const std::string& path)
+		{
+			return RuntimeError(StringBuilder() % "Cannot " % action % " file '" % path % "': " % std::strerror(errno));
+		}
+
+		int OpenFile(const std::string& path, int flags)
+		{
+			int fd;
+			do fd = ::open(path.c_str(), flags | O_CLOEXEC, 0666);
+			while (fd < 0 && errno == EINTR);
+
+			PET_CHECK(fd >= 0, MakeFileError("open", path));
+			return fd;
+		}
+
+		// Returns the number of bytes read, less than size only at the end of the file
+		size_t ReadFully(int fd, char* data, size_t size, const std::string& path)
+		{
+			size_t total = 0;
+			while (total < size)
+			{
+				const auto result = ::read(fd, data + total, size - total);
+				if (result == 0)
+					break;
+
+				if (result < 0)
+				{
+					PET_CHECK(errno == EINTR, MakeFileError("read", path));
+					continue;
+				}
+
+				total += static_cast<size_t>(result);
+			}
+
+			return total;
+		}
+
+		void WriteParts(int fd, const std::vector<std::string_view>& parts, const std::string& path)
+		{
+			std::vector<iovec> vectors;
+			vectors.reserve(parts.size());
+
+			for (const auto part : parts)
+				if (!part.empty())
+					vectors.push_back(iovec{const_cast<char*>(part.data()), part.size()});
+
+			auto current = vectors.begin();
+			while (current != vectors.end())
+			{
+				const auto count = std::min<ptrdiff_t>(vectors.end() - current, IOV_MAX);
+				const auto result = ::writev(fd, &*current, static_cast<int>(count));
+
+				if (result < 0)
+				{
+					PET_CHECK(errno == EINTR, MakeFileError("write", path));
+					continue;
+				}
+
+				// Skip what was written, which may end in the middle of a part
+				auto written = static_cast<size_t>(result);
+				while (current != vectors.end() && written >= current->iov_len) written -= (current++)->iov_len;
+
+				if (written != 0)
+				{
+					current->iov_base = static_cast<char*>(current->iov_base) + written;
+					current->iov_len -= written;
+				}
+			}
+		}
+
+		// Files mapped by MapFile, by the address of their mapping, until the last string using the mapping is gone
+		class MappedFiles
+		{
+			std::mutex								   _mutex;
+			std::unordered_map<const void*, struct stat> _files;
+
+		public:
+			static MappedFiles& GetInstance()
+			{
+				static MappedFiles instance;
+				return instance;
+			}
+
+			void Add(const void* data, const struct stat& status)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_files.emplace(data, status);
+			}
+
+			void Remove(const void* data)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_files.erase(data);
+			}
+
+			bool Contains(const struct stat& status)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				return std::any_of(_files.begin(), _files.end(), [&status](const auto& file)
+								   { return file.second.st_dev == status.st_dev && file.second.st_ino == status.st_ino; });
+			}
+		};
+
+		bool IsMapped(const std::string& path)
+		{
+			struct stat status;
+			return ::stat(path.c_str(), &status) == 0 && MappedFiles::GetInstance().Contains(status);
+		}
+
+		// Creates a file next to path under a name no other thread or process uses. The name is not random, like the ones of
+		// mkostemp, so that the file gets the usual permissions of a new file rather than 0600.
+		int CreateTemporaryFile(const std::string& path, std::string& temporaryPath)
+		{
+			static std::atomic<uint64_t> counter{0};
+
+			while (true)
+			{
+				temporaryPath = StringBuilder() % path % "." % ::getpid() % "." % counter++ % ".tmp";
+
+				const auto fd = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+				if (fd >= 0)
+					return fd;
+
+				PET_CHECK(errno == EEXIST || errno == EINTR, MakeFileError("create", temporaryPath));
+			}
+		}
+	}
+
+	String FileSystem::ReadFile(const std::string& path)
+	{
+		const auto	  fd = OpenFile(path, O_RDONLY);
+		ScopedInvoker closeFile([fd]() { ::close(fd); });
+
+		struct stat status;
+		PET_CHECK(::fstat(fd, &status) == 0, MakeFileError("read", path));
+
+		// Regular files are read straight into a buffer of their size, anything else (pipes, devices) in chunks
+		if (S_ISREG(status.st_mode))
+		{
+			const auto size = static_cast<size_t>(status.st_size);
+			if (size == 0)
+				return String();
+
+			std::unique_ptr<char[]> data(new char[size]);
+			const auto				length = ReadFully(fd, data.get(), size, path);
+
+			if (length == size)
+				return String(std::make_shared<StringBuffer>(data.release(), size, [](char* buffer, size_t) { delete[] buffer; }));
+
+			return String(std::string_view(data.get(), length));
+		}
+
+		std::string result;
+		while (true)
+		{
+			const auto size = result.size();
+			result.resize(size + ReadChunkSize);
+
+			const auto length = ReadFully(fd, result.data() + size, ReadChunkSize, path);
+			result.resize(size + length);
+
+			if (length < ReadChunkSize)
+				break;
+		}
+
+		return String(result);
+	}
+
+	String FileSystem::MapFile(const std::string& path)
+	{
+		const auto	  fd = OpenFile(path, O_RDONLY);
+		ScopedInvoker closeFile([fd]() { ::close(fd); });
+
+		struct stat status;
+		PET_CHECK(::fstat(fd, &status) == 0, MakeFileError("map", path));
+		PET_CHECK(S_ISREG(status.st_mode), RuntimeError(StringBuilder() % "Cannot map file '" % path % "': not a regular file"));
+
+		const auto size = static_cast<size_t>(status.st_size);
+		if (size == 0)
+			return String();
+
+		const auto data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		PET_CHECK(data != MAP_FAILED, MakeFileError("map", path));
+
+		// Scripts mostly scan mappings from start to end, which makes aggressive read-ahead pay off
+		::madvise(data, size, MADV_SEQUENTIAL);
+
+		MappedFiles::GetInstance().Add(data, status);
+
+		const auto unmap = [](char* buffer, size_t length)
+		{
+			MappedFiles::GetInstance().Remove(buffer);
+			::munmap(buffer, length);
+		};
+		return String(std::make_shared<StringBuffer>(static_cast<char*>(data), size, unmap));
+	}
+
+	void FileSystem::ReplaceFile(const std::string& path, const std::vector<std::string_view>& parts)
+	{
+		struct stat status;
+		const auto	exists = ::stat(path.c_str(), &status) == 0;
+
+		std::string temporaryPath;
+		const auto	fd = CreateTemporaryFile(path, temporaryPath);
+
+		bool		  isRenamed = false;
+		ScopedInvoker cleanUp(
+			[&]()
+			{
+				::close(fd);
+				if (!isRenamed)
+					::unlink(temporaryPath.c_str());
+			});
+
+		if (exists)
+			PET_CHECK(::fchmod(fd, status.st_mode & 07777) == 0, MakeFileError("write", temporaryPath));
+
+		WriteParts(fd, parts, temporaryPath);
+
+		PET_CHECK(::rename(temporaryPath.c_str(), path.c_str()) == 0, MakeFileError("replace", path));
+		isRenamed = true;
+	}
+
+	void FileSystem::WriteFile(const std::string& path, const std::vector<std::string_view>& parts, bool append)
+	{
+		// Truncating a file this process maps would make its mappings raise SIGBUS when read, including the parts being written
+		// if they come from one, so such a file is replaced instead. Its mappings keep the old contents.
+		if (!append && IsMapped(path))
+			return ReplaceFile(path, parts);
+
+		const auto	  fd = OpenFile(path, O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC));
+		ScopedInvoker closeFile([fd]() { ::close(fd); });
+
+		WriteParts(fd, parts, path);
+	}
+}
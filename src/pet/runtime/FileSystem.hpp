@@ -0,0 +1,29 @@
+#pragma once
+
+#include <pet/runtime/String.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pet
+{
+	// File access for the fs builtins, on top of POSIX calls
+	struct FileSystem
+	{
+		// Reads a whole file into a single exactly sized buffer
+		static String ReadFile(const std::string& path);
+
+		// Maps a whole file read-only and returns it as a string backed by the mapping, so nothing is copied and pages are only
+		// loaded when accessed. The file must not be truncated while the string is alive.
+		static String MapFile(const std::string& path);
+
+		// Writes parts one after another with writev, in as few system calls as possible. A file mapped by MapFile is not
+		// truncated but replaced by a new file, so the mapping keeps the old contents.
+		static void WriteFile(const std::string& path, const std::vector<std::string_view>& parts, bool append);
+
+		// Writes parts to a new file next to path and renames it over path. Readers never see a partial file, and those that have
+		// the previous one open or mapped, in this process or another, keep its contents.
+		static void ReplaceFile(const std::string& path, const std::vector<std::string_view>& parts);
+	};
+}
@@ -1,19 +1,32 @@
 #pragma once
 
 #include <pet/runtime/Scope.hpp>
-#include <pet/Statement.hpp>
+#include <pet/FunctionBody.hpp>
 
 #include <toolkit/Macro.hpp>
 
 namespace pet
 {
+	class Context;
 	struct ScriptFunction;
 
+	struct FunctionInvoker;
+	PET_DECLARE_UNIQ_PTR(FunctionInvoker);
+
 	struct FunctionInvoker
 	{
 		virtual ~FunctionInvoker() = default;
 
 		virtual ValuePtr InvokeScriptFunction(ScriptFunction& function, const std::vector<ValuePtr>& arguments) = 0;
+
+		virtual Context& GetContext() = 0;
+
+		// 0 for the main interpreter, unique for the ones forked from it. Objects created by an invoker belong to its id.
+		virtual size_t GetId() const = 0;
+
+		// Creates an invoker for another thread. It sees the scopes of this one but cannot assign variables declared in them, nor
+		// modify the objects it reaches through them.
+		virtual FunctionInvokerUniqPtr Fork() const = 0;
 	};
 
 	struct Function
@@ -29,14 +42,13 @@ namespace pet
 
 	struct ScriptFunction final : public Function
 	{
-		ScopePtr					  Closure;
-		StringPoolId				  Id;
-		std::vector<StringPoolId>	  Parameters;
-		std::vector<StatementUniqPtr> Body;
-
-		ScriptFunction(const ScopePtr& closure, StringPoolId id, std::vector<StringPoolId>&& parameters,
-					   std::vector<StatementUniqPtr>&& body)
-			: Closure(closure), Id(id), Parameters(std::move(parameters)), Body(std::move(body))
+		ScopePtr				  Closure;
+		StringPoolId			  Id;
+		std::vector<StringPoolId> Parameters;
+		FunctionBodyPtr			  Body;
+
+		ScriptFunction(const ScopePtr& closure, StringPoolId id, const std::vector<StringPoolId>& parameters, const FunctionBodyPtr& body)
+			: Closure(closure), Id(id), Parameters(parameters), Body(body)
 		{
 		}
 
@@ -0,0 +1,400 @@
+#include <pet/runtime/Future.hpp>
+
+#include <pet/Context.hpp>
+#include <pet/ModuleCache.hpp>
+#include <pet/runtime/Array.hpp>
+#include <pet/runtime/Dictionary.hpp>
+#include <pet/runtime/Scope.hpp>
+#include <pet/runtime/Serializer.hpp>
+
+#include <toolkit/FlatHashMap.hpp>
+#include <toolkit/ScopedInvoker.hpp>
+
+#include <thread>
+#include <unordered_set>
+
+namespace pet
+{
+	namespace
+	{
+		// Collects the identifiers a function body refers to, those in the functions it defines included. Bodies which fail to
+		// parse refer to nothing, they throw when invoked anyway.
+		class IdentifierCollector final : public ExpressionVisitor, public StatementVisitor
+		{
+		private:
+			Context&						 _context;
+			std::unordered_set<StringPoolId> _ids;
+
+		public:
+			explicit IdentifierCollector(Context& context) : _context(context)
+			{
+			}
+
+			std::unordered_set<StringPoolId> Collect(FunctionBody& body)
+			{
+				VisitBody(body);
+				return std::move(_ids);
+			}
+
+			void VisitBinary(BinaryExpression& expression) override
+			{
+				expression.Left->Visit(*this);
+				expression.Right->Visit(*this);
+			}
+
+			void VisitGrouping(GroupingExpression& expression) override
+			{
+				expression.Expression->Visit(*this);
+			}
+
+			void VisitUnary(UnaryExpression& expression) override
+			{
+				expression.Right->Visit(*this);
+			}
+
+			void VisitLiteral(LiteralExpression&) override
+			{
+			}
+
+			void VisitDictionary(DictionaryExpression&) override
+			{
+			}
+
+			void VisitArray(ArrayExpression& expression) override
+			{
+				for (const auto& value : expression.Values) value->Visit(*this);
+			}
+
+			void VisitMember(MemberExpression& expression) override
+			{
+				expression.Target->Visit(*this);
+				expression.Key->Visit(*this);
+			}
+
+			void VisitFunction(FunctionExpression& expression) override
+			{
+				VisitBody(*expression.Body);
+			}
+
+			void VisitIdentifier(IdentifierExpression& expression) override
+			{
+				_ids.insert(expression.Id);
+			}
+
+			void VisitAssignment(AssignmentExpression& expression) override
+			{
+				expression.Target->Visit(*this);
+				expression.Value->Visit(*this);
+			}
+
+			void VisitLogical(LogicalExpression& expression) override
+			{
+				expression.Left->Visit(*this);
+				expression.Right->Visit(*this);
+			}
+
+			void VisitCall(CallExpression& expression) override
+			{
+				expression.Callee->Visit(*this);
+				for (const auto& argument : expression.Arguments) argument->Visit(*this);
+			}
+
+			void VisitVariableDeclaration(VariableDeclarationStatement& statement) override
+			{
+				if (statement.Value)
+					statement.Value->Visit(*this);
+			}
+
+			void VisitFunctionDeclaration(FunctionDeclarationStatement& statement) override
+			{
+				VisitBody(*statement.Body);
+			}
+
+			void VisitExpression(ExpressionStatement& statement) override
+			{
+				statement.Expression->Visit(*this);
+			}
+
+			void VisitBlock(BlockStatement& statement) override
+			{
+				for (const auto& child : statement.Statements) child->Visit(*this);
+			}
+
+			void VisitIf(IfStatement& statement) override
+			{
+				statement.Condition->Visit(*this);
+				statement.StatementTrue->Visit(*this);
+				if (statement.StatementFalse)
+					statement.StatementFalse->Visit(*this);
+			}
+
+			void VisitWhile(WhileStatement& statement) override
+			{
+				statement.Condition->Visit(*this);
+				statement.Body->Visit(*this);
+			}
+
+			void VisitBreak(BreakStatement&) override
+			{
+			}
+
+			void VisitReturn(ReturnStatement& statement) override
+			{
+				if (statement.Value)
+					statement.Value->Visit(*this);
+			}
+
+			void VisitContinue(ContinueStatement&) override
+			{
+			}
+
+			void VisitImport(ImportStatement&) override
+			{
+			}
+
+		private:
+			void VisitBody(FunctionBody& body)
+			{
+				const StatementBlock* statements;
+
+				try
+				{
+					statements = &body.GetStatements(_context);
+				}
+				catch (const std::exception&)
+				{
+					return;
+				}
+
+				for (const auto& statement : *statements) statement->Visit(*this);
+			}
+		};
+
+		// Copies belong to the interpreter running on the calling thread, scopes included. A script function only gets the
+		// captured variables its body refers to, so a task does not pay for the large variables of the scopes around it.
+		class ValueCopier
+		{
+		private:
+			Context&										  _context;
+			FlatHashMap<const void*, ValuePtr, PointerHasher> _copies;
+			FlatHashMap<const void*, ScopePtr, PointerHasher> _scopes;
+
+		public:
+			explicit ValueCopier(Context& context) : _context(context)
+			{
+			}
+
+			ValuePtr Copy(const ValuePtr& value)
+			{
+				if (value->IsArray())
+					return CopyArray(value->AsArray());
+
+				if (value->IsDictionary())
+					return CopyDictionary(value->AsDictionary());
+
+				if (value->IsFunction())
+					return CopyFunction(value);
+
+				return value;
+			}
+
+			// Script functions are copied with the scopes they capture. The other functions, natives and futures, hold no state
+			// the script can modify and are shared.
+			ValuePtr CopyFunction(const ValuePtr& value)
+			{
+				const auto function = std::dynamic_pointer_cast<ScriptFunction>(value->AsFunction());
+				if (!function)
+					return value;
+
+				if (const auto copy = _copies.Find(function.get()))
+					return *copy;
+
+				// The closure is registered before the variables are copied, as a variable may hold the function itself
+				const auto closure = CopyScope(function->Closure);
+				const auto copy =
+					Register(function.get(), FunctionPtr(std::make_shared<ScriptFunction>(closure, function->Id, function->Parameters,
+																						   function->Body)));
+
+				CopyVariables(function->Closure, closure, IdentifierCollector(_context).Collect(*function->Body));
+
+				return copy;
+			}
+
+		private:
+			// Copies the scope and its parents without their variables. Scopes are shared by all the functions copied, each adds
+			// the variables it refers to.
+			ScopePtr CopyScope(const ScopePtr& scope)
+			{
+				if (!scope)
+					return nullptr;
+
+				if (const auto copy = _scopes.Find(scope.get()))
+					return *copy;
+
+				const auto copy = std::make_shared<Scope>(CopyScope(scope->GetParent()), Object::GetCurrentOwnerId(), scope);
+				_scopes.InsertOrAssign(scope.get(), copy);
+
+				return copy;
+			}
+
+			// Copies each of ids from the innermost scope declaring it, like a lookup would find it. A variable is declared before
+			// its value is copied, so that functions referring to each other stop there.
+			void CopyVariables(ScopePtr scope, ScopePtr copy, std::unordered_set<StringPoolId>&& ids)
+			{
+				for (; scope && !ids.empty(); scope = scope->GetParent(), copy = copy->GetParent())
+					for (auto it = ids.begin(); it != ids.end();)
+					{
+						const auto value = scope->TryGet(*it);
+						if (!value)
+						{
+							++it;
+							continue;
+						}
+
+						if (!copy->Has(*it))
+						{
+							copy->Declare(*it, NullValue, scope->IsConst(*it));
+							copy->Assign(*it, Copy(value));
+						}
+
+						it = ids.erase(it);
+					}
+			}
+
+			ValuePtr CopyArray(const ArrayPtr& array)
+			{
+				if (const auto copy = _copies.Find(array.get()))
+					return *copy;
+
+				const auto& storage = array->GetStorage();
+				if (const auto values = std::get_if<std::vector<ValueIntegerType>>(&storage))
+					return Register(array.get(), std::make_shared<Array>(std::vector<ValueIntegerType>(*values)));
+				if (const auto values = std::get_if<std::vector<ValueFloatType>>(&storage))
+					return Register(array.get(), std::make_shared<Array>(std::vector<ValueFloatType>(*values)));
+
+				const auto& values = std::get<std::vector<ValuePtr>>(storage);
+
+				const auto copy = std::make_shared<Array>(std::vector<ValuePtr>());
+				const auto result = Register(array.get(), copy);
+
+				std::vector<ValuePtr> copiedValues;
+				copiedValues.reserve(values.size());
+				for (const auto& value : values) copiedValues.push_back(Copy(value));
+
+				copy->Assign(std::move(copiedValues));
+				return result;
+			}
+
+			ValuePtr CopyDictionary(const DictionaryPtr& dictionary)
+			{
+				if (const auto copy = _copies.Find(dictionary.get()))
+					return *copy;
+
+				// Entries are copied after the dictionary is registered, so records stay in the shape mode they were in
+				const auto copy = std::make_shared<Dictionary>();
+				const auto result = Register(dictionary.get(), copy);
+
+				dictionary->ForEach([&](const auto& key, const ValuePtr& value)
+									{ copy->Set(Copy(std::make_shared<Value>(Value(key))), Copy(value)); });
+
+				return result;
+			}
+
+			template <typename T>
+			ValuePtr Register(const void* original, const std::shared_ptr<T>& copy)
+			{
+				auto result = std::make_shared<Value>(copy);
+				_copies.InsertOrAssign(original, result);
+
+				return result;
+			}
+		};
+	}
+
+	Future::Future() : _isDone(false)
+	{
+	}
+
+	FuturePtr Future::Spawn(FunctionInvoker& invoker, const FunctionPtr& function, const std::vector<ValuePtr>& arguments)
+	{
+		auto future = std::make_shared<Future>();
+
+		std::shared_ptr<FunctionInvoker> worker = invoker.Fork();
+
+		// One copier keeps the objects shared by the arguments and the captured variables shared. The arguments belong to the
+		// task, the captured variables and the objects only they reach stay the spawner's, so they are read-only to the task.
+		ValueCopier copier(invoker.GetContext());
+
+		std::vector<ValuePtr> copiedArguments;
+		copiedArguments.reserve(arguments.size());
+
+		{
+			const auto ownerId = Object::SetCurrentOwnerId(worker->GetId());
+			const ScopedInvoker si([ownerId]() { Object::SetCurrentOwnerId(ownerId); });
+
+			for (const auto& argument : arguments) copiedArguments.push_back(copier.Copy(argument));
+		}
+
+		const auto copiedFunction = copier.CopyFunction(std::make_shared<Value>(function))->AsFunction();
+
+		invoker.GetContext().GetThreadPool().Submit(
+			[future, function = copiedFunction, worker, arguments = std::move(copiedArguments),
+			 importChain = ModuleCache::GetImportChain()]()
+			{
+				const auto ownerId = Object::SetCurrentOwnerId(worker->GetId());
+				const auto callerImportChain = ModuleCache::SetImportChain(importChain);
+				const ScopedInvoker si(
+					[ownerId, &callerImportChain]()
+					{
+						Object::SetCurrentOwnerId(ownerId);
+						ModuleCache::SetImportChain(callerImportChain);
+					});
+
+				try
+				{
+					future->Complete(function->Invoke(*worker, arguments), nullptr);
+				}
+				catch (...)
+				{
+					future->Complete(nullptr, std::current_exception());
+				}
+			});
+
+		return future;
+	}
+
+	ValuePtr Future::Await(FunctionInvoker& invoker)
+	{
+		auto& pool = invoker.GetContext().GetThreadPool();
+
+		while (!_isDone.load(std::memory_order_acquire))
+			if (!pool.TryRunTask())
+				std::this_thread::yield();
+
+		if (_exception)
+			std::rethrow_exception(_exception);
+
+		// Each awaiter gets a copy of its own, the result itself stays untouched as it may be awaited again
+		return Copy(invoker.GetContext(), _result);
+	}
+
+	ValuePtr Future::Invoke(FunctionInvoker& invoker, const std::vector<ValuePtr>&)
+	{
+		return Await(invoker);
+	}
+
+	ValuePtr Future::Copy(Context& context, const ValuePtr& value)
+	{
+		if (!value->IsObject())
+			return value;
+
+		return ValueCopier(context).Copy(value);
+	}
+
+	void Future::Complete(ValuePtr&& result, std::exception_ptr&& exception)
+	{
+		_result = std::move(result);
+		_exception = std::move(exception);
+		_isDone.store(true, std::memory_order_release);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <pet/runtime/Function.hpp>
+
+#include <atomic>
+#include <exception>
+
+namespace pet
+{
+	class Future;
+	PET_DECLARE_PTR(Future);
+
+	// Result of a function running as a task of the thread pool of the context, on an interpreter of its own. Arguments and results are
+	// handed over as deep copies, so that the spawning thread and the task never share an array or a dictionary. The function runs on a
+	// copy of the captured variables it refers to, taken when it is spawned, which the task can read but not modify. A future is a
+	// function value, calling it awaits it. Tasks nobody awaits still run before the context is destroyed.
+	class Future final : public Function
+	{
+	private:
+		// The result and the exception are only read once the task is done, which publishes them
+		std::atomic<bool>  _isDone;
+		ValuePtr		   _result;
+		std::exception_ptr _exception;
+
+	public:
+		Future();
+
+		static FuturePtr Spawn(FunctionInvoker& invoker, const FunctionPtr& function, const std::vector<ValuePtr>& arguments);
+
+		// Returns the result of the task or rethrows its error once it ends. Like ThreadPool::ParallelFor, the waiting thread runs
+		// queued tasks meanwhile, so tasks may await other tasks, and a pool without threads runs the task right there.
+		ValuePtr Await(FunctionInvoker& invoker);
+
+		ValuePtr Invoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments) override;
+
+		std::string GetName() const override
+		{
+			return "future";
+		}
+
+		std::optional<size_t> GetParametersCount() const override
+		{
+			return 0;
+		}
+
+		// Copies arrays, dictionaries and script functions reachable from value, keeping cycles and shared parts. Functions get
+		// the captured variables their bodies refer to, whose bodies context parses if needed. Other values are immutable and shared.
+		static ValuePtr Copy(Context& context, const ValuePtr& value);
+
+	private:
+		void Complete(ValuePtr&& result, std::exception_ptr&& exception);
+	};
+}
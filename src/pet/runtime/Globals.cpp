@@ -1,13 +1,25 @@
 #include <pet/runtime/Globals.hpp>
 
+#include <pet/Context.hpp>
 #include <pet/Error.hpp>
+#include <pet/ModuleCache.hpp>
 #include <pet/runtime/Array.hpp>
+#include <pet/runtime/Csv.hpp>
 #include <pet/runtime/Dictionary.hpp>
+#include <pet/runtime/FileSystem.hpp>
+#include <pet/runtime/Future.hpp>
+#include <pet/runtime/Json.hpp>
+#include <pet/runtime/Kernels.hpp>
+#include <pet/runtime/Serializer.hpp>
+#include <pet/runtime/ValueWriter.hpp>
 
 #include <chrono>
 #include <iostream>
 
+#include <toolkit/NumberUtils.hpp>
 #include <toolkit/StringJoiner.hpp>
+#include <toolkit/ScopedInvoker.hpp>
+#include <toolkit/StringUtils.hpp>
 
 namespace pet
 {
@@ -50,7 +62,13 @@ namespace pet
 				if constexpr (std::is_same_v<ValueIntegerType, T> || std::is_same_v<ValueFloatType, T>)
 					return static_cast<ValueIntegerType>(value);
 				else if constexpr (std::is_same_v<ValueStringType, T>)
-					return std::stoll(value);
+				{
+					// Malformed strings are reported by Cast
+					const auto result = NumberUtils::Parse<ValueIntegerType>(value.GetView());
+					PET_CHECK(result, NotSupportedException());
+
+					return *result;
+				}
 				else
 					PET_THROW(NotSupportedException());
 			}
@@ -66,19 +84,63 @@ namespace pet
 				else if constexpr (std::is_same_v<ValueIntegerType, T> || std::is_same_v<ValueFloatType, T>)
 					return static_cast<ValueFloatType>(value);
 				else if constexpr (std::is_same_v<ValueStringType, T>)
-					return std::stod(value);
+				{
+					// Malformed strings are reported by Cast
+					const auto result = NumberUtils::Parse<ValueFloatType>(value.GetView());
+					PET_CHECK(result, NotSupportedException());
+
+					return *result;
+				}
 				else
 					PET_THROW(NotSupportedException());
 			}
 		};
 
+		void FlushOutput(Context& context)
+		{
+			auto&						output = context.GetOutput();
+			std::lock_guard<std::mutex> lock(output.GetMutex());
+			output.Flush();
+		}
+
+		// A prompt printed before reading has to be visible, so output is flushed first
+		std::optional<String> ReadLine(Context& context)
+		{
+			FlushOutput(context);
+
+			auto&						input = context.GetInput();
+			std::lock_guard<std::mutex> lock(input.GetMutex());
+
+			return input.ReadLine();
+		}
+
+		// Returned by lines(): every call returns the next line of the standard input, and null once it is exhausted
+		struct NextLineFunction final : public Function
+		{
+			ValuePtr Invoke(FunctionInvoker& invoker, const std::vector<ValuePtr>&) override
+			{
+				const auto line = ReadLine(invoker.GetContext());
+				return line ? std::make_shared<Value>(*line) : NullValue;
+			}
+
+			std::string GetName() const override
+			{
+				return "next_line";
+			}
+
+			std::optional<size_t> GetParametersCount() const override
+			{
+				return 0;
+			}
+		};
+
 		struct ValueLenGetter
 		{
 			template <typename T>
 			ValueIntegerType operator()(const T& value) const
 			{
 				if constexpr (std::is_same_v<ValueStringType, T>)
-					return static_cast<ValueIntegerType>(value.size());
+					return static_cast<ValueIntegerType>(value.GetLength());
 				else if constexpr (std::is_same_v<ValueArrayType, T>)
 					return value->GetLength();
 				else
@@ -86,6 +148,280 @@ namespace pet
 			}
 		};
 
+		void CheckArgumentsCount(const std::vector<ValuePtr>& arguments, size_t minCount, size_t maxCount)
+		{
+			PET_CHECK(arguments.size() >= minCount && arguments.size() <= maxCount,
+					  RuntimeError(StringBuilder() % "Expect " % minCount % " to " % maxCount % " arguments, got " % arguments.size()));
+		}
+
+		const ValueStringType& GetStringArgument(const ValuePtr& argument)
+		{
+			PET_CHECK(argument->IsString(), RuntimeError(StringBuilder() % "Expect string argument, got '" % argument % "'"));
+			return argument->AsString();
+		}
+
+		ValueArrayType GetArrayArgument(const ValuePtr& argument)
+		{
+			PET_CHECK(argument->IsArray(), RuntimeError(StringBuilder() % "Expect array argument, got '" % argument % "'"));
+			return argument->AsArray();
+		}
+
+		// Views of the elements of an array of strings, valid as long as the array is not modified
+		std::vector<std::string_view> GetStringViews(const Array& array)
+		{
+			const auto values = array.TryGetValues<ValuePtr>();
+			PET_CHECK(values || array.GetLength() == 0, RuntimeError("Expect array of strings"));
+
+			std::vector<std::string_view> result;
+			if (values)
+			{
+				result.reserve(values->size());
+				for (const auto& value : *values)
+				{
+					PET_CHECK(value->IsString(), RuntimeError(StringBuilder() % "Expect array of strings, got '" % value % "'"));
+					result.push_back(value->AsString().GetView());
+				}
+			}
+
+			return result;
+		}
+
+		// A string or an array of strings to be written out one after another
+		std::vector<std::string_view> GetTextArgument(const ValuePtr& argument)
+		{
+			if (argument->IsString())
+				return {argument->AsString().GetView()};
+
+			return GetStringViews(*GetArrayArgument(argument));
+		}
+
+		ValueIntegerType GetIntegerArgument(const ValuePtr& argument)
+		{
+			PET_CHECK(argument->IsInteger(), RuntimeError(StringBuilder() % "Expect integer argument, got '" % argument % "'"));
+			return argument->AsInteger();
+		}
+
+		ValueFunctionType GetFunctionArgument(const ValuePtr& argument, size_t parametersCount)
+		{
+			PET_CHECK(argument->IsFunction(), RuntimeError(StringBuilder() % "Expect function argument, got '" % argument % "'"));
+
+			const auto function = argument->AsFunction();
+			const auto functionParametersCount = function->GetParametersCount();
+			PET_CHECK(!functionParametersCount || functionParametersCount == parametersCount,
+					  RuntimeError(StringBuilder() % "Expect function with " % parametersCount % " parameters, '" % function->GetName() %
+								   "' has " % functionParametersCount));
+
+			return function;
+		}
+
+		FuturePtr GetFutureArgument(const ValuePtr& argument)
+		{
+			const auto future = argument->IsFunction() ? std::dynamic_pointer_cast<Future>(argument->AsFunction()) : nullptr;
+			PET_CHECK(future, RuntimeError(StringBuilder() % "Expect future argument, got '" % argument % "'"));
+
+			return future;
+		}
+
+		// Reads { delimiter: ",", header: true, columns: false }, absent options keep their defaults
+		CsvOptions GetCsvOptions(const ValuePtr& argument)
+		{
+			PET_CHECK(argument->IsDictionary(), RuntimeError(StringBuilder() % "Expect dictionary argument, got '" % argument % "'"));
+			const auto options = argument->AsDictionary();
+
+			const auto getOption = [&options](std::string_view name) { return options->Get(std::make_shared<Value>(String(name))); };
+			const auto getBooleanOption = [&getOption](std::string_view name, bool defaultValue)
+			{
+				const auto value = getOption(name);
+				if (value->IsNull())
+					return defaultValue;
+
+				PET_CHECK(value->IsBoolean(), RuntimeError(StringBuilder() % "Expect boolean option '" % name % "', got '" % value % "'"));
+				return value->AsBoolean();
+			};
+
+			CsvOptions result;
+			result.HasHeader = getBooleanOption("header", result.HasHeader);
+			result.AsColumns = getBooleanOption("columns", result.AsColumns);
+
+			if (const auto delimiter = getOption("delimiter"); !delimiter->IsNull())
+			{
+				PET_CHECK(delimiter->IsString() && delimiter->AsString().GetLength() == 1,
+						  RuntimeError(StringBuilder() % "Expect single character delimiter, got '" % delimiter % "'"));
+				result.Delimiter = delimiter->AsString().GetView().front();
+			}
+
+			return result;
+		}
+
+		// Chunks depend only on the array length, so parallel results do not depend on the number of threads
+		constexpr size_t MinChunkSize = 64;
+		constexpr size_t MaxChunkCount = 256;
+
+		// Calls body(invoker, chunk, begin, end) for consecutive chunks of [0, size) on the script thread pool. Every chunk gets its
+		// own forked interpreter, even when there is a single chunk, so callbacks behave the same for any array length. Objects
+		// the callbacks did not create are read-only to them, see Object.
+		template <typename Body>
+		size_t ForEachChunk(FunctionInvoker& invoker, size_t size, Body&& body)
+		{
+			const auto chunkSize = std::max(MinChunkSize, (size + MaxChunkCount - 1) / MaxChunkCount);
+			const auto chunkCount = (size + chunkSize - 1) / chunkSize;
+
+			const auto importChain = ModuleCache::GetImportChain();
+
+			const auto runChunk = [&](size_t chunk)
+			{
+				const auto worker = invoker.Fork();
+
+				const auto ownerId = Object::SetCurrentOwnerId(worker->GetId());
+				const auto callerImportChain = ModuleCache::SetImportChain(importChain);
+				const ScopedInvoker si(
+					[ownerId, &callerImportChain]()
+					{
+						Object::SetCurrentOwnerId(ownerId);
+						ModuleCache::SetImportChain(callerImportChain);
+					});
+
+				const auto begin = chunk * chunkSize;
+				body(*worker, chunk, begin, std::min(begin + chunkSize, size));
+			};
+
+			invoker.GetContext().GetThreadPool().ParallelFor(chunkCount, runChunk);
+
+			return chunkCount;
+		}
+
+		// Gives the objects a chunk created and returned in value to the invoker of the parallel builtin. Nothing else is writable
+		// to the chunk, so the returned value is the only place it can have left them in.
+		void HandOver(const ValuePtr& value, const FunctionInvoker& worker, const FunctionInvoker& invoker)
+		{
+			std::vector<ValuePtr> pending{value};
+
+			while (!pending.empty())
+			{
+				const auto current = std::move(pending.back());
+				pending.pop_back();
+
+				if (!current->IsObject())
+					continue;
+
+				const ObjectPtr object = current->IsArray() ? ObjectPtr(current->AsArray()) : ObjectPtr(current->AsDictionary());
+				if (object->GetOwnerId() != worker.GetId())
+					continue;
+
+				object->SetOwnerId(invoker.GetId());
+
+				if (current->IsDictionary())
+					current->AsDictionary()->ForEach([&pending](const auto&, const ValuePtr& element) { pending.push_back(element); });
+				else if (const auto elements = current->AsArray()->TryGetValues<ValuePtr>())
+					pending.insert(pending.end(), elements->begin(), elements->end());
+			}
+		}
+
+		// Numeric view of an array argument: typed arrays are read in place, generic arrays of numbers are unboxed once
+		class NumericArray
+		{
+		private:
+			ValueArrayType						 _array;
+			const std::vector<ValueIntegerType>* _integers;
+			const std::vector<ValueFloatType>*	 _floats;
+
+			std::vector<ValueIntegerType> _unboxedIntegers;
+			std::vector<ValueFloatType>	  _unboxedFloats;
+
+		public:
+			explicit NumericArray(const ValuePtr& argument)
+				: _array(GetArrayArgument(argument)),
+				  _integers(_array->TryGetValues<ValueIntegerType>()),
+				  _floats(_array->TryGetValues<ValueFloatType>())
+			{
+				if (_integers || _floats)
+					return;
+
+				const auto& values = std::get<std::vector<ValuePtr>>(_array->GetStorage());
+
+				auto isInteger = true;
+				for (const auto& value : values)
+				{
+					PET_CHECK(value->IsNumber(), RuntimeError(StringBuilder() % "Expect numeric array argument, got '" % argument % "'"));
+					isInteger = isInteger && value->IsInteger();
+				}
+
+				if (isInteger)
+				{
+					_unboxedIntegers.reserve(values.size());
+					for (const auto& value : values) _unboxedIntegers.push_back(value->AsInteger());
+					_integers = &_unboxedIntegers;
+				}
+				else
+				{
+					_unboxedFloats.reserve(values.size());
+					for (const auto& value : values) _unboxedFloats.push_back(value->AsFloat());
+					_floats = &_unboxedFloats;
+				}
+			}
+
+			bool IsInteger() const
+			{
+				return _integers != nullptr;
+			}
+
+			size_t GetSize() const
+			{
+				return _integers ? _integers->size() : _floats->size();
+			}
+
+			const std::vector<ValueIntegerType>& GetIntegers() const
+			{
+				return *_integers;
+			}
+
+			const std::vector<ValueFloatType>& GetFloats()
+			{
+				if (!_floats)
+				{
+					_unboxedFloats.assign(_integers->begin(), _integers->end());
+					_floats = &_unboxedFloats;
+				}
+
+				return *_floats;
+			}
+		};
+
+		template <typename T>
+		ValuePtr MakeArray(std::vector<T>&& values)
+		{
+			return std::make_shared<Value>(std::make_shared<Array>(std::move(values)));
+		}
+
+		template <typename T, typename Right, typename Operation>
+		ValuePtr ApplyElementWise(const std::vector<T>& left, Right right, Operation&& operation)
+		{
+			std::vector<T> result(left.size());
+			operation(left.data(), right, result.data(), left.size());
+
+			return MakeArray(std::move(result));
+		}
+
+		// Applies the operation to an array and either a number or an array of the same length, in integers if both sides are
+		template <typename Operation>
+		ValuePtr ApplyElementWise(const std::vector<ValuePtr>& arguments, Operation&& operation)
+		{
+			NumericArray left(arguments[0]);
+			const auto&	 right = arguments[1];
+
+			if (right->IsNumber())
+				return left.IsInteger() && right->IsInteger() ? ApplyElementWise(left.GetIntegers(), right->AsInteger(), operation)
+															  : ApplyElementWise(left.GetFloats(), right->AsFloat(), operation);
+
+			NumericArray rightArray(right);
+			PET_CHECK(left.GetSize() == rightArray.GetSize(),
+					  RuntimeError(StringBuilder() % "Array lengths differ: " % left.GetSize() % " and " % rightArray.GetSize()));
+
+			return left.IsInteger() && rightArray.IsInteger()
+					   ? ApplyElementWise(left.GetIntegers(), rightArray.GetIntegers().data(), operation)
+					   : ApplyElementWise(left.GetFloats(), rightArray.GetFloats().data(), operation);
+		}
+
 		template <typename R, typename VisitorType>
 		ValuePtr Cast(const ValuePtr& value)
 		{
@@ -131,26 +467,143 @@ namespace pet
 			std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count()));
 	}
 
-	ValuePtr PrintFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	ValuePtr PrintFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments)
 	{
 		if (!arguments.empty())
 		{
-			StringJoiner sj(" ");
-			for (const auto& argument : arguments) sj % argument;
-			std::cout << sj << std::endl;
+			auto&						output = invoker.GetContext().GetOutput();
+			std::lock_guard<std::mutex> lock(output.GetMutex());
+			ValueWriter<OutputBuffer>	writer(output);
+
+			for (size_t i = 0; i < arguments.size(); ++i)
+			{
+				if (i != 0)
+					output.Write(' ');
+
+				writer.Write(*arguments[i]);
+			}
+
+			output.EndLine();
 		}
 
 		return NullValue;
 	}
 
-	ValuePtr ReadLnFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>&)
+	ValuePtr ReadLnFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>&)
+	{
+		const auto line = ReadLine(invoker.GetContext());
+		return std::make_shared<Value>(line ? *line : String());
+	}
+
+	ValuePtr ReadLinesFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>&)
+	{
+		auto& context = invoker.GetContext();
+		FlushOutput(context);
+
+		auto&						input = context.GetInput();
+		std::lock_guard<std::mutex> lock(input.GetMutex());
+
+		std::vector<ValuePtr> result;
+		while (const auto line = input.ReadLine()) result.push_back(std::make_shared<Value>(*line));
+
+		return MakeArray(std::move(result));
+	}
+
+	ValuePtr LinesFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>&)
+	{
+		static const auto NextLine = std::make_shared<Value>(std::make_shared<NextLineFunction>());
+		return NextLine;
+	}
+
+	ValuePtr ReadAllFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>&)
+	{
+		auto& context = invoker.GetContext();
+		FlushOutput(context);
+
+		auto&						input = context.GetInput();
+		std::lock_guard<std::mutex> lock(input.GetMutex());
+
+		return std::make_shared<Value>(input.ReadAll());
+	}
+
+	ValuePtr FlushFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>&)
+	{
+		FlushOutput(invoker.GetContext());
+		return NullValue;
+	}
+
+	ValuePtr ReadFileFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		return std::make_shared<Value>(FileSystem::ReadFile(GetStringArgument(arguments[0]).ToString()));
+	}
+
+	// The string reads the file's pages directly. If another process truncates the file while the string is alive, reading the
+	// lost pages kills the interpreter with SIGBUS. write_file() replaces mapped files instead of truncating them, so scripts
+	// rewriting a file they mapped are safe.
+	ValuePtr MapFileFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		return std::make_shared<Value>(FileSystem::MapFile(GetStringArgument(arguments[0]).ToString()));
+	}
+
+	ValuePtr WriteFileFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		FileSystem::WriteFile(GetStringArgument(arguments[0]).ToString(), GetTextArgument(arguments[1]), false);
+		return NullValue;
+	}
+
+	ValuePtr AppendFileFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		FileSystem::WriteFile(GetStringArgument(arguments[0]).ToString(), GetTextArgument(arguments[1]), true);
+		return NullValue;
+	}
+
+	ValuePtr JsonParseFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments)
+	{
+		return Json::Parse(GetStringArgument(arguments[0]), invoker.GetContext().GetStringInterner());
+	}
+
+	ValuePtr JsonStringifyFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		std::string result;
+		Json::Write(result, *arguments[0]);
+
+		return std::make_shared<Value>(result);
+	}
+
+	ValuePtr CsvParseFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments)
+	{
+		CheckArgumentsCount(arguments, 1, 2);
+
+		auto& context = invoker.GetContext();
+		return Csv::Read(GetStringArgument(arguments[0]), arguments.size() > 1 ? GetCsvOptions(arguments[1]) : CsvOptions(),
+						 context.GetStringInterner(), context.GetThreadPool());
+	}
+
+	ValuePtr CsvReadFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments)
+	{
+		CheckArgumentsCount(arguments, 1, 2);
+
+		// String fields are slices of the mapped file, which stays mapped while one of them is alive
+		const auto text = FileSystem::MapFile(GetStringArgument(arguments[0]).ToString());
+
+		auto& context = invoker.GetContext();
+		return Csv::Read(text, arguments.size() > 1 ? GetCsvOptions(arguments[1]) : CsvOptions(), context.GetStringInterner(),
+						 context.GetThreadPool());
+	}
+
+	ValuePtr SerializeFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
 	{
 		std::string result;
-		std::getline(std::cin, result);
+		Serializer::Serialize(result, *arguments[0]);
 
 		return std::make_shared<Value>(result);
 	}
 
+	ValuePtr DeserializeFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments)
+	{
+		return Serializer::Deserialize(GetStringArgument(arguments[0]), invoker.GetContext().GetStringInterner());
+	}
+
 	ValuePtr TypeFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
 	{
 		return std::make_shared<Value>(arguments[0]->Visit<std::string>(ValueTyper()));
@@ -179,4 +632,417 @@ namespace pet
 	{
 		return std::make_shared<Value>(arguments[0]->Visit<ValueIntegerType>(ValueLenGetter()));
 	}
+
+	ValuePtr PushFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		const auto array = GetArrayArgument(arguments[0]);
+		array->Push(arguments[1]);
+
+		return std::make_shared<Value>(array->GetLength());
+	}
+
+	ValuePtr PopFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		return GetArrayArgument(arguments[0])->Pop();
+	}
+
+	ValuePtr InsertFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		GetArrayArgument(arguments[0])->Insert(GetIntegerArgument(arguments[1]), arguments[2]);
+		return NullValue;
+	}
+
+	ValuePtr RemoveFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		return GetArrayArgument(arguments[0])->Remove(GetIntegerArgument(arguments[1]));
+	}
+
+	ValuePtr ReserveFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		GetArrayArgument(arguments[0])->Reserve(GetIntegerArgument(arguments[1]));
+		return NullValue;
+	}
+
+	ValuePtr ResizeFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		GetArrayArgument(arguments[0])->Resize(GetIntegerArgument(arguments[1]));
+		return NullValue;
+	}
+
+	ValuePtr CapacityFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		return std::make_shared<Value>(GetArrayArgument(arguments[0])->GetCapacity());
+	}
+
+	ValuePtr SortFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments)
+	{
+		CheckArgumentsCount(arguments, 1, 2);
+
+		const auto array = GetArrayArgument(arguments[0]);
+
+		if (arguments.size() == 1)
+		{
+			array->Sort();
+			return arguments[0];
+		}
+
+		const auto function = GetFunctionArgument(arguments[1], 2);
+
+		// The comparator runs O(n log n) times, so its arguments vector is allocated once
+		std::vector<ValuePtr> comparatorArguments(2);
+
+		const auto isLess = [&](const ValuePtr& left, const ValuePtr& right)
+		{
+			comparatorArguments[0] = left;
+			comparatorArguments[1] = right;
+
+			const auto result = function->Invoke(invoker, comparatorArguments);
+			PET_CHECK(result->IsBoolean(), RuntimeError("Expect boolean result from comparator"));
+
+			return result->AsBoolean();
+		};
+
+		array->Sort(isLess);
+		return arguments[0];
+	}
+
+	ValuePtr FindFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		CheckArgumentsCount(arguments, 2, 3);
+
+		const auto str = GetStringArgument(arguments[0]).GetView();
+		const auto substring = GetStringArgument(arguments[1]).GetView();
+		const auto offset = arguments.size() > 2 ? GetIntegerArgument(arguments[2]) : 0;
+		PET_CHECK(offset >= 0, RuntimeError(StringBuilder() % "Invalid offset " % offset));
+
+		const auto position = StringUtils::Find(str, substring, static_cast<size_t>(offset));
+		if (position == std::string_view::npos)
+			return std::make_shared<Value>(ValueIntegerType(-1));
+
+		return std::make_shared<Value>(static_cast<ValueIntegerType>(position));
+	}
+
+	ValuePtr SplitFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		const auto& str = GetStringArgument(arguments[0]);
+		const auto	separator = GetStringArgument(arguments[1]).GetView();
+		PET_CHECK(!separator.empty(), RuntimeError("Expect non-empty separator"));
+
+		const auto view = str.GetView();
+		const auto parts = StringUtils::Split(view, separator);
+
+		std::vector<ValuePtr> result;
+		result.reserve(parts.size());
+
+		for (const auto part : parts)
+			result.push_back(std::make_shared<Value>(str.Slice(static_cast<size_t>(part.data() - view.data()), part.size())));
+
+		return MakeArray(std::move(result));
+	}
+
+	ValuePtr SubstrFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		CheckArgumentsCount(arguments, 2, 3);
+
+		const auto& str = GetStringArgument(arguments[0]);
+		const auto	strLength = static_cast<ValueIntegerType>(str.GetLength());
+
+		const auto offset = GetIntegerArgument(arguments[1]);
+		PET_CHECK(offset >= 0 && offset <= strLength, RuntimeError(StringBuilder() % "Offset " % offset % " is out of range"));
+
+		const auto length = arguments.size() > 2 ? GetIntegerArgument(arguments[2]) : strLength - offset;
+		PET_CHECK(length >= 0, RuntimeError(StringBuilder() % "Invalid length " % length));
+
+		return std::make_shared<Value>(str.Slice(static_cast<size_t>(offset), static_cast<size_t>(std::min(length, strLength - offset))));
+	}
+
+	ValuePtr StartsWithFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		const auto str = GetStringArgument(arguments[0]).GetView();
+		const auto prefix = GetStringArgument(arguments[1]).GetView();
+
+		return str.substr(0, prefix.size()) == prefix ? TrueValue : FalseValue;
+	}
+
+	ValuePtr EndsWithFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		const auto str = GetStringArgument(arguments[0]).GetView();
+		const auto suffix = GetStringArgument(arguments[1]).GetView();
+
+		return str.size() >= suffix.size() && str.substr(str.size() - suffix.size()) == suffix ? TrueValue : FalseValue;
+	}
+
+	ValuePtr TrimFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		const auto& str = GetStringArgument(arguments[0]);
+		const auto	view = str.GetView();
+
+		constexpr std::string_view Whitespaces = " \t\n\r\f\v";
+
+		const auto begin = view.find_first_not_of(Whitespaces);
+		if (begin == std::string_view::npos)
+			return std::make_shared<Value>(String());
+
+		const auto end = view.find_last_not_of(Whitespaces) + 1;
+		if (begin == 0 && end == view.size())
+			return arguments[0];
+
+		return std::make_shared<Value>(str.Slice(begin, end - begin));
+	}
+
+	ValuePtr JoinFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		const auto parts = GetStringViews(*GetArrayArgument(arguments[0]));
+		const auto separator = GetStringArgument(arguments[1]).GetView();
+
+		return std::make_shared<Value>(String::Join(parts, separator));
+	}
+
+	ValuePtr SumFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		NumericArray array(arguments[0]);
+
+		if (array.IsInteger())
+			return std::make_shared<Value>(Kernels<ValueIntegerType>::Sum(array.GetIntegers().data(), array.GetSize()));
+
+		return std::make_shared<Value>(Kernels<ValueFloatType>::Sum(array.GetFloats().data(), array.GetSize()));
+	}
+
+	ValuePtr MinFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		NumericArray array(arguments[0]);
+		PET_CHECK(array.GetSize() != 0, RuntimeError("Array is empty"));
+
+		if (array.IsInteger())
+			return std::make_shared<Value>(Kernels<ValueIntegerType>::Min(array.GetIntegers().data(), array.GetSize()));
+
+		return std::make_shared<Value>(Kernels<ValueFloatType>::Min(array.GetFloats().data(), array.GetSize()));
+	}
+
+	ValuePtr MaxFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		NumericArray array(arguments[0]);
+		PET_CHECK(array.GetSize() != 0, RuntimeError("Array is empty"));
+
+		if (array.IsInteger())
+			return std::make_shared<Value>(Kernels<ValueIntegerType>::Max(array.GetIntegers().data(), array.GetSize()));
+
+		return std::make_shared<Value>(Kernels<ValueFloatType>::Max(array.GetFloats().data(), array.GetSize()));
+	}
+
+	ValuePtr DotFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		NumericArray left(arguments[0]);
+		NumericArray right(arguments[1]);
+		PET_CHECK(left.GetSize() == right.GetSize(),
+				  RuntimeError(StringBuilder() % "Array lengths differ: " % left.GetSize() % " and " % right.GetSize()));
+
+		if (left.IsInteger() && right.IsInteger())
+			return std::make_shared<Value>(
+				Kernels<ValueIntegerType>::Dot(left.GetIntegers().data(), right.GetIntegers().data(), left.GetSize()));
+
+		return std::make_shared<Value>(Kernels<ValueFloatType>::Dot(left.GetFloats().data(), right.GetFloats().data(), left.GetSize()));
+	}
+
+	ValuePtr CountFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		NumericArray array(arguments[0]);
+
+		const auto& value = arguments[1];
+		PET_CHECK(value->IsNumber(), RuntimeError(StringBuilder() % "Expect numeric argument, got '" % value % "'"));
+
+		const auto result = array.IsInteger() && value->IsInteger()
+								? Kernels<ValueIntegerType>::Count(array.GetIntegers().data(), array.GetSize(), value->AsInteger())
+								: Kernels<ValueFloatType>::Count(array.GetFloats().data(), array.GetSize(), value->AsFloat());
+
+		return std::make_shared<Value>(static_cast<ValueIntegerType>(result));
+	}
+
+	ValuePtr AddFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		const auto& left = arguments[0];
+		const auto& right = arguments[1];
+
+		if (left->IsNumber() && right->IsNumber())
+			return left->IsInteger() && right->IsInteger() ? std::make_shared<Value>(left->AsInteger() + right->AsInteger())
+														   : std::make_shared<Value>(left->AsFloat() + right->AsFloat());
+
+		return ApplyElementWise(arguments, [](const auto* values, auto other, auto* result, size_t size)
+								{ Kernels<std::decay_t<decltype(*values)>>::Add(values, other, result, size); });
+	}
+
+	ValuePtr MulFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		const auto& left = arguments[0];
+		const auto& right = arguments[1];
+
+		if (left->IsNumber() && right->IsNumber())
+			return left->IsInteger() && right->IsInteger() ? std::make_shared<Value>(left->AsInteger() * right->AsInteger())
+														   : std::make_shared<Value>(left->AsFloat() * right->AsFloat());
+
+		return ApplyElementWise(arguments, [](const auto* values, auto other, auto* result, size_t size)
+								{ Kernels<std::decay_t<decltype(*values)>>::Multiply(values, other, result, size); });
+	}
+
+	ValuePtr PrefixSumFunction::DoInvoke(FunctionInvoker&, const std::vector<ValuePtr>& arguments)
+	{
+		NumericArray array(arguments[0]);
+
+		if (array.IsInteger())
+		{
+			std::vector<ValueIntegerType> result(array.GetSize());
+			Kernels<ValueIntegerType>::PrefixSum(array.GetIntegers().data(), result.data(), result.size());
+			return MakeArray(std::move(result));
+		}
+
+		std::vector<ValueFloatType> result(array.GetSize());
+		Kernels<ValueFloatType>::PrefixSum(array.GetFloats().data(), result.data(), result.size());
+		return MakeArray(std::move(result));
+	}
+
+	ValuePtr ParallelMapFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments)
+	{
+		const auto array = GetArrayArgument(arguments[0]);
+		const auto function = GetFunctionArgument(arguments[1], 1);
+
+		std::vector<ValuePtr> result(static_cast<size_t>(array->GetLength()));
+
+		const auto mapChunk = [&](FunctionInvoker& worker, size_t, size_t begin, size_t end)
+		{
+			for (auto i = begin; i < end; ++i)
+			{
+				result[i] = function->Invoke(worker, {array->Get(static_cast<ValueIntegerType>(i))});
+				HandOver(result[i], worker, invoker);
+			}
+		};
+
+		ForEachChunk(invoker, result.size(), mapChunk);
+
+		return MakeArray(std::move(result));
+	}
+
+	ValuePtr ParallelFilterFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments)
+	{
+		const auto array = GetArrayArgument(arguments[0]);
+		const auto function = GetFunctionArgument(arguments[1], 1);
+
+		std::vector<std::vector<ValuePtr>> chunks(MaxChunkCount);
+
+		const auto filterChunk = [&](FunctionInvoker& worker, size_t chunk, size_t begin, size_t end)
+		{
+			for (auto i = begin; i < end; ++i)
+			{
+				auto	   value = array->Get(static_cast<ValueIntegerType>(i));
+				const auto isKept = function->Invoke(worker, {value});
+				PET_CHECK(isKept->IsBoolean(), RuntimeError("Expect boolean result from filter function"));
+
+				if (isKept->AsBoolean())
+					chunks[chunk].push_back(std::move(value));
+			}
+		};
+
+		const auto chunkCount = ForEachChunk(invoker, static_cast<size_t>(array->GetLength()), filterChunk);
+
+		std::vector<ValuePtr> result;
+		for (size_t i = 0; i < chunkCount; ++i) result.insert(result.end(), chunks[i].begin(), chunks[i].end());
+
+		return MakeArray(std::move(result));
+	}
+
+	ValuePtr ParallelReduceFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments)
+	{
+		const auto	array = GetArrayArgument(arguments[0]);
+		const auto	function = GetFunctionArgument(arguments[1], 2);
+		const auto& initial = arguments[2];
+
+		// Integer sums go straight to the vectorized kernel. Float sums are left to the chunked reduction: the kernel adds in an order
+		// that depends on the instruction set, while the chunks only depend on the array length, so every machine gets the same result
+		if (dynamic_cast<const AddFunction*>(function.get()) && initial->IsInteger() && array->TryGetValues<ValueIntegerType>())
+			return function->Invoke(invoker, {initial, SumFunction().Invoke(invoker, {arguments[0]})});
+
+		// Chunks are reduced starting from their first element and then folded into the initial value in order, which gives the
+		// sequential result for any associative function
+		std::vector<ValuePtr> chunks(MaxChunkCount);
+
+		const auto reduceChunk = [&](FunctionInvoker& worker, size_t chunk, size_t begin, size_t end)
+		{
+			auto result = array->Get(static_cast<ValueIntegerType>(begin));
+			for (auto i = begin + 1; i < end; ++i)
+				result = function->Invoke(worker, {result, array->Get(static_cast<ValueIntegerType>(i))});
+
+			HandOver(result, worker, invoker);
+			chunks[chunk] = std::move(result);
+		};
+
+		const auto chunkCount = ForEachChunk(invoker, static_cast<size_t>(array->GetLength()), reduceChunk);
+
+		auto result = initial;
+		for (size_t i = 0; i < chunkCount; ++i) result = function->Invoke(invoker, {result, chunks[i]});
+
+		return result;
+	}
+
+	ValuePtr SpawnFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments)
+	{
+		PET_CHECK(!arguments.empty(), RuntimeError("Expect function argument"));
+
+		const auto function = GetFunctionArgument(arguments[0], arguments.size() - 1);
+		return std::make_shared<Value>(Future::Spawn(invoker, function, std::vector<ValuePtr>(arguments.begin() + 1, arguments.end())));
+	}
+
+	ValuePtr AwaitFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments)
+	{
+		return GetFutureArgument(arguments[0])->Await(invoker);
+	}
+
+	ValuePtr AwaitAllFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>& arguments)
+	{
+		const auto array = GetArrayArgument(arguments[0]);
+
+		std::vector<FuturePtr> futures;
+		for (ValueIntegerType i = 0; i < array->GetLength(); ++i) futures.push_back(GetFutureArgument(array->Get(i)));
+
+		std::vector<ValuePtr> result;
+		result.reserve(futures.size());
+		for (const auto& future : futures) result.push_back(future->Await(invoker));
+
+		return MakeArray(std::move(result));
+	}
+
+	// { threads, tasks, steals, caller_tasks, workers: [{ queue_depth, tasks, steals, utilization }] }
+	ValuePtr SchedulerStatsFunction::DoInvoke(FunctionInvoker& invoker, const std::vector<ValuePtr>&)
+	{
+		auto&	   context = invoker.GetContext();
+		const auto stats = context.GetThreadPool().GetStats();
+
+		const auto set = [&context](Dictionary& dictionary, std::string_view key, Value&& value)
+		{ dictionary.Set(std::make_shared<Value>(context.GetStringInterner().Intern(key)), std::make_shared<Value>(std::move(value))); };
+		const auto toInteger = [](uint64_t value) { return static_cast<ValueIntegerType>(value); };
+
+		uint64_t			  taskCount = stats.CallerTaskCount;
+		uint64_t			  stealCount = 0;
+		std::vector<ValuePtr> workers;
+
+		for (const auto& worker : stats.Workers)
+		{
+			const auto dictionary = std::make_shared<Dictionary>();
+			set(*dictionary, "queue_depth", toInteger(worker.QueueDepth));
+			set(*dictionary, "tasks", toInteger(worker.TaskCount));
+			set(*dictionary, "steals", toInteger(worker.StealCount));
+			set(*dictionary, "utilization", worker.Utilization);
+
+			workers.push_back(std::make_shared<Value>(dictionary));
+			taskCount += worker.TaskCount;
+			stealCount += worker.StealCount;
+		}
+
+		const auto result = std::make_shared<Dictionary>();
+		set(*result, "threads", toInteger(context.GetThreadPool().GetThreadCount()));
+		set(*result, "tasks", toInteger(taskCount));
+		set(*result, "steals", toInteger(stealCount));
+		set(*result, "caller_tasks", toInteger(stats.CallerTaskCount));
+		set(*result, "workers", Value(std::make_shared<Array>(std::move(workers))));
+
+		return std::make_shared<Value>(result);
+	}
 }
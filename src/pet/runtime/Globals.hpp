@@ -48,6 +48,28 @@ namespace pet
 	// I/O
 	DECLARE_NATIVE_FUNCTION(PrintFunction, "print", std::nullopt);
 	DECLARE_NATIVE_FUNCTION(ReadLnFunction, "readln", 0);
+	DECLARE_NATIVE_FUNCTION(ReadLinesFunction, "readlines", 0);
+	DECLARE_NATIVE_FUNCTION(LinesFunction, "lines", 0);
+	DECLARE_NATIVE_FUNCTION(ReadAllFunction, "read_all", 0);
+	DECLARE_NATIVE_FUNCTION(FlushFunction, "flush", 0);
+
+	// Files
+	DECLARE_NATIVE_FUNCTION(ReadFileFunction, "read_file", 1);
+	DECLARE_NATIVE_FUNCTION(MapFileFunction, "map_file", 1);
+	DECLARE_NATIVE_FUNCTION(WriteFileFunction, "write_file", 2);
+	DECLARE_NATIVE_FUNCTION(AppendFileFunction, "append_file", 2);
+
+	// JSON
+	DECLARE_NATIVE_FUNCTION(JsonParseFunction, "json_parse", 1);
+	DECLARE_NATIVE_FUNCTION(JsonStringifyFunction, "json_stringify", 1);
+
+	// CSV
+	DECLARE_NATIVE_FUNCTION(CsvParseFunction, "csv_parse", std::nullopt);
+	DECLARE_NATIVE_FUNCTION(CsvReadFunction, "csv_read", std::nullopt);
+
+	// Serialization
+	DECLARE_NATIVE_FUNCTION(SerializeFunction, "serialize", 1);
+	DECLARE_NATIVE_FUNCTION(DeserializeFunction, "deserialize", 1);
 
 	// Types
 	DECLARE_NATIVE_FUNCTION(TypeFunction, "type", 1);
@@ -58,6 +80,46 @@ namespace pet
 	// General
 	DECLARE_NATIVE_FUNCTION(LenFunction, "len", 1);
 
+	// Arrays
+	DECLARE_NATIVE_FUNCTION(PushFunction, "push", 2);
+	DECLARE_NATIVE_FUNCTION(PopFunction, "pop", 1);
+	DECLARE_NATIVE_FUNCTION(InsertFunction, "insert", 3);
+	DECLARE_NATIVE_FUNCTION(RemoveFunction, "remove", 2);
+	DECLARE_NATIVE_FUNCTION(ReserveFunction, "reserve", 2);
+	DECLARE_NATIVE_FUNCTION(ResizeFunction, "resize", 2);
+	DECLARE_NATIVE_FUNCTION(CapacityFunction, "capacity", 1);
+	DECLARE_NATIVE_FUNCTION(SortFunction, "sort", std::nullopt);
+
+	// Strings
+	DECLARE_NATIVE_FUNCTION(FindFunction, "find", std::nullopt);
+	DECLARE_NATIVE_FUNCTION(SplitFunction, "split", 2);
+	DECLARE_NATIVE_FUNCTION(SubstrFunction, "substr", std::nullopt);
+	DECLARE_NATIVE_FUNCTION(StartsWithFunction, "starts_with", 2);
+	DECLARE_NATIVE_FUNCTION(EndsWithFunction, "ends_with", 2);
+	DECLARE_NATIVE_FUNCTION(TrimFunction, "trim", 1);
+	DECLARE_NATIVE_FUNCTION(JoinFunction, "join", 2);
+
+	// Numeric
+	DECLARE_NATIVE_FUNCTION(SumFunction, "sum", 1);
+	DECLARE_NATIVE_FUNCTION(MinFunction, "min", 1);
+	DECLARE_NATIVE_FUNCTION(MaxFunction, "max", 1);
+	DECLARE_NATIVE_FUNCTION(DotFunction, "dot", 2);
+	DECLARE_NATIVE_FUNCTION(CountFunction, "count", 2);
+	DECLARE_NATIVE_FUNCTION(AddFunction, "add", 2);
+	DECLARE_NATIVE_FUNCTION(MulFunction, "mul", 2);
+	DECLARE_NATIVE_FUNCTION(PrefixSumFunction, "prefix_sum", 1);
+
+	// Parallel
+	DECLARE_NATIVE_FUNCTION(ParallelMapFunction, "pmap", 2);
+	DECLARE_NATIVE_FUNCTION(ParallelFilterFunction, "pfilter", 2);
+	DECLARE_NATIVE_FUNCTION(ParallelReduceFunction, "preduce", 3);
+
+	// Tasks
+	DECLARE_NATIVE_FUNCTION(SpawnFunction, "spawn", std::nullopt);
+	DECLARE_NATIVE_FUNCTION(AwaitFunction, "await", 1);
+	DECLARE_NATIVE_FUNCTION(AwaitAllFunction, "await_all", 1);
+	DECLARE_NATIVE_FUNCTION(SchedulerStatsFunction, "scheduler_stats", 0);
+
 #undef DECLARE_NATIVE_FUNCTION
 
 	using Globals = std::unordered_map<StringPoolId, ValuePtr>;
@@ -0,0 +1,107 @@
+#include <pet/runtime/InputReader.hpp>
+
+#include <toolkit/Exception.hpp>
+#include <toolkit/Macro.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <unistd.h>
+
+namespace pet
+{
+	InputReader::InputReader(int fd) : _fd(fd), _position(0), _isEndOfInput(false)
+	{
+	}
+
+	std::optional<String> InputReader::ReadLine()
+	{
+		// Bytes of the tail already searched for '\n', which a line spanning several chunks does not search again
+		size_t searched = 0;
+
+		while (true)
+		{
+			const auto view = _chunk.GetView();
+			const auto rest = view.size() - _position;
+
+			const auto from = view.data() + _position + searched;
+			const auto end = rest != searched ? static_cast<const char*>(std::memchr(from, '\n', rest - searched)) : nullptr;
+			if (end)
+			{
+				const auto length = static_cast<size_t>(end - (view.data() + _position));
+				auto	   line = _chunk.Slice(_position, length);
+
+				_position += length + 1;
+				return line;
+			}
+
+			searched = rest;
+
+			if (!ReadChunk())
+			{
+				if (rest == 0)
+					return std::nullopt;
+
+				auto line = _chunk.Slice(_position, rest);
+
+				_position = view.size();
+				return line;
+			}
+		}
+	}
+
+	String InputReader::ReadAll()
+	{
+		std::string result(_chunk.GetView().substr(_position));
+		_chunk = String();
+		_position = 0;
+
+		while (!_isEndOfInput)
+		{
+			const auto size = result.size();
+			result.resize(size + ChunkSize);
+			result.resize(size + Read(result.data() + size, ChunkSize));
+		}
+
+		return String(result);
+	}
+
+	bool InputReader::ReadChunk()
+	{
+		if (_isEndOfInput)
+			return false;
+
+		if (!_buffer)
+			_buffer = std::make_unique<char[]>(ChunkSize);
+
+		const auto size = Read(_buffer.get(), ChunkSize);
+		if (size == 0)
+			return false;
+
+		// Only the unconsumed tail of the previous chunk is kept, and lines already returned keep the old chunk alive. The tail
+		// grows in place or into a buffer twice its size, so a line spanning many chunks is copied a constant number of times.
+		_chunk = _chunk.Slice(_position, _chunk.GetLength() - _position).Concat(std::string_view(_buffer.get(), size));
+		_position = 0;
+
+		return true;
+	}
+
+	size_t InputReader::Read(char* data, size_t size)
+	{
+		while (true)
+		{
+			const auto result = ::read(_fd, data, size);
+			if (result > 0)
+				return static_cast<size_t>(result);
+
+			if (result == 0)
+			{
+				_isEndOfInput = true;
+				return 0;
+			}
+
+			PET_CHECK(errno == EINTR, InputOutputException());
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <pet/runtime/String.hpp>
+
+#include <toolkit/Macro.hpp>
+
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace pet
+{
+	// Reads a file descriptor in large chunks with plain read() calls, bypassing iostreams. Every chunk is stored in one string
+	// buffer and lines are returned as slices of it, so reading a line copies nothing.
+	// Methods are not synchronized: readers sharing an instance between threads lock GetMutex().
+	class InputReader
+	{
+		PET_NON_COPYABLE(InputReader);
+
+		static constexpr size_t ChunkSize = 256 * 1024;
+
+	private:
+		int						_fd;
+		std::unique_ptr<char[]> _buffer;
+		String					_chunk;
+		size_t					_position;
+		bool					_isEndOfInput;
+		std::mutex				_mutex;
+
+	public:
+		explicit InputReader(int fd);
+
+		std::mutex& GetMutex()
+		{
+			return _mutex;
+		}
+
+		// Returns the next line without its '\n', or nothing once the input is exhausted
+		std::optional<String> ReadLine();
+
+		// Returns everything left in the input
+		String ReadAll();
+
+	private:
+		// Reads what is available into the chunk after its unconsumed part. Returns false at the end of the input.
+		bool ReadChunk();
+
+		size_t Read(char* data, size_t size);
+	};
+}
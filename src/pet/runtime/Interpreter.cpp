@@ -7,9 +7,10 @@
 #include <pet/runtime/Dictionary.hpp>
 
 #include <toolkit/ScopedInvoker.hpp>
-#include <toolkit/StringUtils.hpp>
 
+#include <atomic>
 #include <cmath>
+#include <utility>
 
 namespace pet
 {
@@ -36,6 +37,39 @@ namespace pet
 		}
 	}
 
+	Interpreter::Interpreter(Context& context, Globals&& globals)
+		: _context(context),
+		  _id(0),
+		  _anonymousFunctionId(context.GetIdentifierPool().Add("")),
+		  _globals(std::move(globals)),
+		  _scope(std::make_shared<Scope>()),
+		  _loopDepth(0),
+		  _functionDepth(0)
+	{
+	}
+
+	Interpreter::Interpreter(Context& context, const Globals& globals, size_t id)
+		: _context(context),
+		  _id(id),
+		  _anonymousFunctionId(context.GetIdentifierPool().Add("")),
+		  _globals(globals),
+		  _scope(std::make_shared<Scope>(nullptr, id)),
+		  _loopDepth(0),
+		  _functionDepth(0)
+	{
+	}
+
+	FunctionInvokerUniqPtr Interpreter::Fork() const
+	{
+		return ForkInterpreter();
+	}
+
+	std::unique_ptr<Interpreter> Interpreter::ForkInterpreter() const
+	{
+		static std::atomic<size_t> lastId(0);
+		return std::make_unique<Interpreter>(_context, _globals, ++lastId);
+	}
+
 	void Interpreter::Execute(const StatementUniqPtr& statement)
 	{
 		statement->Visit(*this);
@@ -43,153 +77,156 @@ namespace pet
 
 	void Interpreter::VisitBinary(BinaryExpression& expression)
 	{
-		const auto left = Evaluate(expression.Left);
-		const auto right = Evaluate(expression.Right);
-		ValuePtr   result;
+		Value	 leftElement, rightElement;
+		ValuePtr leftBoxed, rightBoxed;
+
+		const auto& left = EvaluateOperand(expression.Left, leftElement, leftBoxed);
+		const auto& right = EvaluateOperand(expression.Right, rightElement, rightBoxed);
+		ValuePtr	result;
 
 		switch (expression.Operator)
 		{
 		case TokenKind::Minus:
 		{
-			PET_CHECK(left->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '-'"));
-			PET_CHECK(right->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '-'"));
-			result = (left->IsInteger() && right->IsInteger()) ? std::make_shared<Value>(left->AsInteger() - right->AsInteger())
-															   : std::make_shared<Value>(left->AsFloat() - right->AsFloat());
+			PET_CHECK(left.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '-'"));
+			PET_CHECK(right.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '-'"));
+			result = (left.IsInteger() && right.IsInteger()) ? std::make_shared<Value>(left.AsInteger() - right.AsInteger())
+															   : std::make_shared<Value>(left.AsFloat() - right.AsFloat());
 			break;
 		}
 		case TokenKind::Asterisk:
 		{
-			PET_CHECK(left->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '*'"));
-			PET_CHECK(right->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '*'"));
-			result = (left->IsInteger() && right->IsInteger()) ? std::make_shared<Value>(left->AsInteger() * right->AsInteger())
-															   : std::make_shared<Value>(left->AsFloat() * right->AsFloat());
+			PET_CHECK(left.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '*'"));
+			PET_CHECK(right.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '*'"));
+			result = (left.IsInteger() && right.IsInteger()) ? std::make_shared<Value>(left.AsInteger() * right.AsInteger())
+															   : std::make_shared<Value>(left.AsFloat() * right.AsFloat());
 			break;
 		}
 		case TokenKind::Power:
 		{
-			PET_CHECK(left->IsNumber(),
+			PET_CHECK(left.IsNumber(),
 					  RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '" % expression.Operator % "'"));
-			PET_CHECK(right->IsNumber(),
+			PET_CHECK(right.IsNumber(),
 					  RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '" % expression.Operator % "'"));
 
-			result = (left->IsInteger() && right->IsInteger())
-						 ? std::make_shared<Value>(static_cast<ValueIntegerType>(std::pow(left->AsInteger(), right->AsInteger())))
-						 : std::make_shared<Value>(std::pow(left->AsFloat(), right->AsFloat()));
+			result = (left.IsInteger() && right.IsInteger())
+						 ? std::make_shared<Value>(static_cast<ValueIntegerType>(std::pow(left.AsInteger(), right.AsInteger())))
+						 : std::make_shared<Value>(std::pow(left.AsFloat(), right.AsFloat()));
 			break;
 		}
 		case TokenKind::Slash:
 		{
-			PET_CHECK(left->IsNumber(),
+			PET_CHECK(left.IsNumber(),
 					  RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '" % expression.Operator % "'"));
-			PET_CHECK(right->IsNumber(),
+			PET_CHECK(right.IsNumber(),
 					  RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '" % expression.Operator % "'"));
 
-			if (left->IsInteger() && right->IsInteger())
+			if (left.IsInteger() && right.IsInteger())
 			{
-				const auto rightValue = right->AsInteger();
+				const auto rightValue = right.AsInteger();
 				PET_CHECK(rightValue != 0, RuntimeError("Divide by zero exception"));
-				result = std::make_shared<Value>(left->AsInteger() / rightValue);
+				result = std::make_shared<Value>(left.AsInteger() / rightValue);
 			}
 			else
 			{
-				const auto rightValue = right->AsFloat();
+				const auto rightValue = right.AsFloat();
 				PET_CHECK(std::fpclassify(rightValue) != FP_ZERO, RuntimeError("Divide by zero exception"));
-				result = std::make_shared<Value>(left->AsFloat() / rightValue);
+				result = std::make_shared<Value>(left.AsFloat() / rightValue);
 			}
 
 			break;
 		}
 		case TokenKind::Plus:
 		{
-			if (left->IsString() && right->IsString())
+			if (left.IsString() && right.IsString())
 			{
-				result = std::make_shared<Value>(StringUtils::Concat(left->AsString(), right->AsString()));
+				result = std::make_shared<Value>(left.AsString().Concat(right.AsString()));
 				break;
 			}
-			PET_CHECK(left->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '+'"));
-			PET_CHECK(right->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '+'"));
-			result = (left->IsInteger() && right->IsInteger()) ? std::make_shared<Value>(left->AsInteger() + right->AsInteger())
-															   : std::make_shared<Value>(left->AsFloat() + right->AsFloat());
+			PET_CHECK(left.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '+'"));
+			PET_CHECK(right.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '+'"));
+			result = (left.IsInteger() && right.IsInteger()) ? std::make_shared<Value>(left.AsInteger() + right.AsInteger())
+															   : std::make_shared<Value>(left.AsFloat() + right.AsFloat());
 			break;
 		}
 		case TokenKind::Percent:
 		{
-			PET_CHECK(left->IsInteger(),
+			PET_CHECK(left.IsInteger(),
 					  RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '" % expression.Operator % "'"));
-			PET_CHECK(right->IsInteger(),
+			PET_CHECK(right.IsInteger(),
 					  RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '" % expression.Operator % "'"));
 
-			const auto rightValue = right->AsInteger();
+			const auto rightValue = right.AsInteger();
 			PET_CHECK(rightValue != 0, RuntimeError("Divide by zero exception"));
-			result = std::make_shared<Value>(left->AsInteger() % rightValue);
+			result = std::make_shared<Value>(left.AsInteger() % rightValue);
 
 			break;
 		}
 		case TokenKind::GreaterThan:
 		{
-			PET_CHECK(left->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '>'"));
-			PET_CHECK(right->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '>'"));
-			result = (left->IsInteger() && right->IsInteger()) ? (left->AsInteger() > right->AsInteger() ? TrueValue : FalseValue)
-															   : (left->AsFloat() > right->AsFloat() ? TrueValue : FalseValue);
+			PET_CHECK(left.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '>'"));
+			PET_CHECK(right.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '>'"));
+			result = (left.IsInteger() && right.IsInteger()) ? (left.AsInteger() > right.AsInteger() ? TrueValue : FalseValue)
+															   : (left.AsFloat() > right.AsFloat() ? TrueValue : FalseValue);
 			break;
 		}
 		case TokenKind::GreaterThanOrEquals:
 		{
-			PET_CHECK(left->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '>='"));
-			PET_CHECK(right->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '>='"));
-			result = (left->IsInteger() && right->IsInteger()) ? (left->AsInteger() >= right->AsInteger() ? TrueValue : FalseValue)
-															   : (left->AsFloat() >= right->AsFloat() ? TrueValue : FalseValue);
+			PET_CHECK(left.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '>='"));
+			PET_CHECK(right.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '>='"));
+			result = (left.IsInteger() && right.IsInteger()) ? (left.AsInteger() >= right.AsInteger() ? TrueValue : FalseValue)
+															   : (left.AsFloat() >= right.AsFloat() ? TrueValue : FalseValue);
 			break;
 		}
 		case TokenKind::LessThan:
 		{
-			PET_CHECK(left->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '<'"));
-			PET_CHECK(right->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '<'"));
-			result = (left->IsInteger() && right->IsInteger()) ? (left->AsInteger() < right->AsInteger() ? TrueValue : FalseValue)
-															   : (left->AsFloat() < right->AsFloat() ? TrueValue : FalseValue);
+			PET_CHECK(left.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '<'"));
+			PET_CHECK(right.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '<'"));
+			result = (left.IsInteger() && right.IsInteger()) ? (left.AsInteger() < right.AsInteger() ? TrueValue : FalseValue)
+															   : (left.AsFloat() < right.AsFloat() ? TrueValue : FalseValue);
 			break;
 		}
 		case TokenKind::LessThanOrEquals:
 		{
-			PET_CHECK(left->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '<='"));
-			PET_CHECK(right->IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '<='"));
-			result = (left->IsInteger() && right->IsInteger()) ? (left->AsInteger() <= right->AsInteger() ? TrueValue : FalseValue)
-															   : (left->AsFloat() <= right->AsFloat() ? TrueValue : FalseValue);
+			PET_CHECK(left.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number left operand for operator '<='"));
+			PET_CHECK(right.IsNumber(), RuntimeError(StringBuilder() % "Invalid non-number right operand for operator '<='"));
+			result = (left.IsInteger() && right.IsInteger()) ? (left.AsInteger() <= right.AsInteger() ? TrueValue : FalseValue)
+															   : (left.AsFloat() <= right.AsFloat() ? TrueValue : FalseValue);
 			break;
 		}
 		case TokenKind::Equals:
 		{
-			if (left->IsNull() && right->IsNull())
+			if (left.IsNull() && right.IsNull())
 				result = TrueValue;
-			else if (left->IsNull() || right->IsNull())
+			else if (left.IsNull() || right.IsNull())
 				result = FalseValue;
-			else if (left->IsBoolean() && right->IsBoolean())
-				result = left->AsBoolean() == right->AsBoolean() ? TrueValue : FalseValue;
-			else if (left->IsInteger() && right->IsInteger())
-				result = left->AsInteger() == right->AsInteger() ? TrueValue : FalseValue;
-			else if (left->IsFloat() && right->IsFloat())
+			else if (left.IsBoolean() && right.IsBoolean())
+				result = left.AsBoolean() == right.AsBoolean() ? TrueValue : FalseValue;
+			else if (left.IsInteger() && right.IsInteger())
+				result = left.AsInteger() == right.AsInteger() ? TrueValue : FalseValue;
+			else if (left.IsFloat() && right.IsFloat())
 				result =
-					std::abs(right->AsFloat() - left->AsFloat()) <= std::numeric_limits<ValueFloatType>::epsilon() ? TrueValue : FalseValue;
-			else if (left->IsString() && right->IsString())
-				result = left->AsString() == right->AsString() ? TrueValue : FalseValue;
+					std::abs(right.AsFloat() - left.AsFloat()) <= std::numeric_limits<ValueFloatType>::epsilon() ? TrueValue : FalseValue;
+			else if (left.IsString() && right.IsString())
+				result = left.AsString() == right.AsString() ? TrueValue : FalseValue;
 			else
 				PET_THROW(RuntimeError(StringBuilder() % "Invalid operand types for operator '" % expression.Operator % "'"));
 			break;
 		}
 		case TokenKind::NotEquals:
 		{
-			if (left->IsNull() && right->IsNull())
+			if (left.IsNull() && right.IsNull())
 				result = FalseValue;
-			else if (left->IsNull() || right->IsNull())
+			else if (left.IsNull() || right.IsNull())
 				result = TrueValue;
-			else if (left->IsBoolean() && right->IsBoolean())
-				result = left->AsBoolean() == right->AsBoolean() ? FalseValue : TrueValue;
-			else if (left->IsInteger() && right->IsInteger())
-				result = left->AsInteger() == right->AsInteger() ? FalseValue : TrueValue;
-			else if (left->IsFloat() && right->IsFloat())
+			else if (left.IsBoolean() && right.IsBoolean())
+				result = left.AsBoolean() == right.AsBoolean() ? FalseValue : TrueValue;
+			else if (left.IsInteger() && right.IsInteger())
+				result = left.AsInteger() == right.AsInteger() ? FalseValue : TrueValue;
+			else if (left.IsFloat() && right.IsFloat())
 				PET_THROW(NotImplementedException());
-			else if (left->IsString() && right->IsString())
-				result = left->AsString() == right->AsString() ? FalseValue : TrueValue;
+			else if (left.IsString() && right.IsString())
+				result = left.AsString() == right.AsString() ? FalseValue : TrueValue;
 			else
 				PET_THROW(RuntimeError(StringBuilder() % "Invalid operand types for operator '" % expression.Operator % "'"));
 
@@ -238,7 +275,7 @@ namespace pet
 
 	void Interpreter::VisitLiteral(LiteralExpression& expression)
 	{
-		_evaluationResult = std::make_shared<Value>(std::move(expression.Value));
+		_evaluationResult = expression.Value;
 	}
 
 	void Interpreter::VisitDictionary(DictionaryExpression&)
@@ -261,14 +298,12 @@ namespace pet
 		const auto target = Evaluate(expression.Target);
 		PET_CHECK(target->IsObject(), RuntimeError(StringBuilder() % "Failed to access member for non-object variable"));
 
-		const auto key = Evaluate(expression.Key);
-		_evaluationResult = target->IsDictionary() ? target->AsDictionary()->Get(key) : target->AsArray()->Get(key);  // TODO: Optimize me
+		_evaluationResult = GetMember(expression, *target, Evaluate(expression.Key));
 	}
 
 	void Interpreter::VisitFunction(FunctionExpression& expression)
 	{
-		_evaluationResult = MakeHeapValue<ScriptFunction>(_scope, _context.GetIdentifierPool().Add(""), std::move(expression.Parameters),
-														  std::move(expression.Body));
+		_evaluationResult = MakeHeapValue<ScriptFunction>(_scope, _anonymousFunctionId, expression.Parameters, expression.Body);
 	}
 
 	void Interpreter::VisitIdentifier(IdentifierExpression& expression)
@@ -304,7 +339,13 @@ namespace pet
 
 			const auto key = Evaluate(memberExpression->Key);
 			const auto value = Evaluate(expression.Value);
-			target->IsDictionary() ? target->AsDictionary()->Set(key, value) : target->AsArray()->Set(key, value);	// TODO: Optimize me
+
+			if (!target->IsDictionary())
+				target->AsArray()->Set(key, value);
+			else if (CanUseInlineCache(*memberExpression))
+				target->AsDictionary()->Set(key, value, memberExpression->Cache);
+			else
+				target->AsDictionary()->Set(key, value);
 		}
 		else
 		{
@@ -325,6 +366,9 @@ namespace pet
 			PET_CHECK(!scope->IsConst(identifierExpression->Id),
 					  RuntimeError(StringBuilder() % "Cannot assign to constant variable '" %
 								   _context.GetIdentifierPool().Get(identifierExpression->Id) % "'"));
+			PET_CHECK(_id == 0 || scope->GetOwnerId() == _id,
+					  RuntimeError(StringBuilder() % "Cannot assign to captured variable '" %
+								   _context.GetIdentifierPool().Get(identifierExpression->Id) % "' from another thread"));
 
 			scope->Assign(identifierExpression->Id, Evaluate(expression.Value));
 		}
@@ -406,9 +450,7 @@ namespace pet
 		PET_CHECK(!_scope->Has(statement.Id), RuntimeError(StringBuilder() % "Function '" % _context.GetIdentifierPool().Get(statement.Id) %
 														   "' is already declared in this scope"));
 
-		_scope->Declare(statement.Id,
-						MakeHeapValue<ScriptFunction>(_scope, statement.Id, std::move(statement.Parameters), std::move(statement.Body)),
-						false);
+		_scope->Declare(statement.Id, MakeHeapValue<ScriptFunction>(_scope, statement.Id, statement.Parameters, statement.Body), false);
 
 		_statementResult = StatementResult::Empty();
 	}
@@ -421,7 +463,7 @@ namespace pet
 
 	void Interpreter::VisitBlock(BlockStatement& statement)
 	{
-		ExecuteBlock(statement.Statements, std::make_shared<Scope>(_scope));
+		ExecuteBlock(statement.Statements, std::make_shared<Scope>(_scope, _id));
 	}
 
 	void Interpreter::VisitIf(IfStatement& statement)
@@ -482,9 +524,75 @@ namespace pet
 		_statementResult = StatementResult::Continue();
 	}
 
+	void Interpreter::VisitImport(ImportStatement& statement)
+	{
+		auto importer = _scope.get();
+		while (importer->GetParent()) importer = importer->GetParent().get();
+
+		// Module code runs as top-level code, whatever the import is nested in
+		const auto execute = [this](const StatementBlock& statements, const ScopePtr& scope)
+		{
+			const auto loopDepth = std::exchange(_loopDepth, 0);
+			const auto functionDepth = std::exchange(_functionDepth, 0);
+
+			const ScopedInvoker si(
+				[&]()
+				{
+					_loopDepth = loopDepth;
+					_functionDepth = functionDepth;
+				});
+
+			ExecuteBlock(statements, scope);
+		};
+
+		const auto module = _context.GetModules().Import(statement.Path, *importer, _context, _id, execute);
+
+		// Values declared by an earlier import of the same module, directly or through another module, are skipped
+		module->ForEach(
+			[&](StringPoolId id, const ValuePtr& value, bool)
+			{
+				if (_scope->TryGet(id) == value)
+					return;
+
+				PET_CHECK(!_scope->Has(id), RuntimeError(StringBuilder() % "'" % _context.GetIdentifierPool().Get(id) %
+														 "' imported from '" % statement.Path % "' is already declared in this scope"));
+				_scope->Declare(id, value, true);
+			});
+
+		_statementResult = StatementResult::Empty();
+	}
+
+	const Value& Interpreter::EvaluateOperand(const ExpressionUniqPtr& expression, Value& element, ValuePtr& value)
+	{
+		if (expression->GetKind() != ExpressionKind::Member)
+		{
+			value = Evaluate(expression);
+			return *value;
+		}
+
+		auto&	   member = static_cast<MemberExpression&>(*expression);
+		const auto target = Evaluate(member.Target);
+		PET_CHECK(target->IsObject(), RuntimeError(StringBuilder() % "Failed to access member for non-object variable"));
+
+		const auto key = Evaluate(member.Key);
+		if (target->IsArray() && target->AsArray()->TryGetNumber(*key, element))
+			return element;
+
+		value = GetMember(member, *target, key);
+		return *value;
+	}
+
+	ValuePtr Interpreter::GetMember(MemberExpression& expression, const Value& target, const ValuePtr& key)
+	{
+		if (target.IsDictionary())
+			return CanUseInlineCache(expression) ? target.AsDictionary()->Get(key, expression.Cache) : target.AsDictionary()->Get(key);
+
+		return target.AsArray()->Get(key);
+	}
+
 	ValuePtr Interpreter::InvokeScriptFunction(ScriptFunction& function, const std::vector<ValuePtr>& arguments)
 	{
-		const auto scope = std::make_shared<Scope>(function.Closure);
+		const auto scope = std::make_shared<Scope>(function.Closure, _id);
 
 		for (size_t i = 0; i < function.Parameters.size(); ++i) scope->Declare(function.Parameters[i], arguments[i], false);
 
@@ -497,7 +605,7 @@ namespace pet
 				--_functionDepth;
 			});
 
-		ExecuteBlock(function.Body, scope);
+		ExecuteBlock(function.Body->GetStatements(_context), scope);
 		return _statementResult.Kind == StatementResult::Kind::Return ? _statementResult.Value : NullValue;
 	}
 
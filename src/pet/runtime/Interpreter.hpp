@@ -46,6 +46,10 @@ namespace pet
 	private:
 		Context& _context;
 
+		// The main interpreter has id 0, interpreters forked for worker threads get unique non-zero ids
+		const size_t	   _id;
+		const StringPoolId _anonymousFunctionId;
+
 		const Globals _globals;
 		ScopePtr	  _scope;
 
@@ -56,12 +60,46 @@ namespace pet
 		size_t _functionDepth;
 
 	public:
-		Interpreter(Context& context, Globals&& globals)
-			: _context(context), _globals(std::move(globals)), _scope(std::make_shared<Scope>()), _loopDepth(0), _functionDepth(0)
+		Interpreter(Context& context, Globals&& globals);
+		Interpreter(Context& context, const Globals& globals, size_t id);
+
+		void Execute(const StatementUniqPtr& statement);
+
+		const Globals& GetGlobals() const
 		{
+			return _globals;
 		}
 
-		void Execute(const StatementUniqPtr& statement);
+		// The scope top-level statements are executed in. It is only replaced between them.
+		const ScopePtr& GetGlobalScope() const
+		{
+			return _scope;
+		}
+
+		void SetGlobalScope(const ScopePtr& scope)
+		{
+			_scope = scope;
+		}
+
+		void ResetGlobalScope()
+		{
+			_scope = std::make_shared<Scope>(nullptr, _id);
+		}
+
+		Context& GetContext() override
+		{
+			return _context;
+		}
+
+		size_t GetId() const override
+		{
+			return _id;
+		}
+
+		FunctionInvokerUniqPtr Fork() const override;
+
+		// A forked interpreter has a unique id and a global scope of its own, and can run on another thread than this one
+		std::unique_ptr<Interpreter> ForkInterpreter() const;
 
 	private:
 		void VisitBinary(BinaryExpression& expression) override;
@@ -86,11 +124,24 @@ namespace pet
 		void VisitBreak(BreakStatement& statement) override;
 		void VisitReturn(ReturnStatement& statement) override;
 		void VisitContinue(ContinueStatement& statement) override;
+		void VisitImport(ImportStatement& statement) override;
 
 		ValuePtr InvokeScriptFunction(ScriptFunction& function, const std::vector<ValuePtr>& arguments) override;
 
 		ValuePtr Evaluate(const ExpressionUniqPtr& expression);
 
+		// Evaluates an operand of an operator, which only needs its value: an element of an unboxed array is read into element
+		// without being boxed, anything else is evaluated into value
+		const Value& EvaluateOperand(const ExpressionUniqPtr& expression, Value& element, ValuePtr& value);
+
+		ValuePtr GetMember(MemberExpression& expression, const Value& target, const ValuePtr& key);
+
+		// The key of a member with an inline cache never changes
+		static bool CanUseInlineCache(const MemberExpression& expression)
+		{
+			return expression.Key->GetKind() == ExpressionKind::Literal;
+		}
+
 		void ExecuteBlock(const std::vector<StatementUniqPtr>& statements, const ScopePtr& scope);
 	};
 }
@@ -0,0 +1,726 @@
+#include <pet/runtime/Json.hpp>
+
+#include <pet/Error.hpp>
+#include <pet/runtime/Array.hpp>
+#include <pet/runtime/Dictionary.hpp>
+
+#include <toolkit/NumberUtils.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <iterator>
+#include <variant>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace pet
+{
+	namespace
+	{
+		// Returns the first '"', '\' or control character in [current, end), or end
+		const char* FindStringSpecial(const char* current, const char* end)
+		{
+#ifdef __SSE2__
+			const auto quote = _mm_set1_epi8('"');
+			const auto backslash = _mm_set1_epi8('\\');
+			const auto lastControl = _mm_set1_epi8(0x1F);
+
+			for (; end - current >= 16; current += 16)
+			{
+				const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+
+				// Unsigned x <= 0x1F is min(x, 0x1F) == x
+				const auto special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+												  _mm_cmpeq_epi8(_mm_min_epu8(chunk, lastControl), chunk));
+
+				if (const auto mask = _mm_movemask_epi8(special))
+					return current + __builtin_ctz(static_cast<unsigned>(mask));
+			}
+#endif
+
+			for (; current != end; ++current)
+				if (*current == '"' || *current == '\\' || static_cast<unsigned char>(*current) < 0x20)
+					break;
+
+			return current;
+		}
+
+		void AppendUtf8(std::string& output, uint32_t codePoint)
+		{
+			if (codePoint < 0x80)
+				output.push_back(static_cast<char>(codePoint));
+			else if (codePoint < 0x800)
+			{
+				output.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+				output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+			}
+			else if (codePoint < 0x10000)
+			{
+				output.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+				output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+				output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+			}
+			else
+			{
+				output.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+				output.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+				output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+				output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+			}
+		}
+
+		enum class ArrayKind
+		{
+			Empty,
+			Integers,
+			Floats,
+			Values
+		};
+
+		using Number = std::variant<ValueIntegerType, ValueFloatType>;
+
+		class Parser
+		{
+		private:
+			const String&	_text;
+			StringInterner& _interner;
+
+			const char* _begin;
+			const char* _current;
+			const char* _end;
+			size_t		_depth;
+			Shape*		_recordShape;
+
+			// Members of the arrays and objects being parsed, so that containers are built with their final size
+			std::vector<ValuePtr>		  _values;
+			std::vector<ValueIntegerType> _integers;
+			std::vector<ValueFloatType>	  _floats;
+			std::vector<String>			  _keys;
+			std::string					  _unescaped;
+
+		public:
+			Parser(const String& text, StringInterner& interner)
+				: _text(text), _interner(interner), _begin(text.GetView().data()), _current(_begin), _end(_begin + text.GetLength()),
+				  _depth(0), _recordShape(nullptr)
+			{
+			}
+
+			ValuePtr ParseDocument()
+			{
+				SkipWhitespace();
+				auto result = ParseValue();
+				SkipWhitespace();
+
+				PET_CHECK(_current == _end, MakeError("Unexpected characters after the value"));
+				return result;
+			}
+
+		private:
+			RuntimeError MakeError(const std::string& message) const
+			{
+				return RuntimeError(StringBuilder() % "Invalid JSON at offset " % (_current - _begin) % ": " % message);
+			}
+
+			void SkipWhitespace()
+			{
+				while (_current != _end && (*_current == ' ' || *_current == '\n' || *_current == '\r' || *_current == '\t')) ++_current;
+			}
+
+			bool TryConsume(char c)
+			{
+				if (_current == _end || *_current != c)
+					return false;
+
+				++_current;
+				return true;
+			}
+
+			void Expect(char c)
+			{
+				PET_CHECK(TryConsume(c), MakeError(StringBuilder() % "Expect '" % c % "'"));
+			}
+
+			ValuePtr ExpectLiteral(std::string_view literal, const ValuePtr& value)
+			{
+				PET_CHECK(static_cast<size_t>(_end - _current) >= literal.size() && std::string_view(_current, literal.size()) == literal,
+						  MakeError("Invalid literal"));
+
+				_current += literal.size();
+				return value;
+			}
+
+			void Enter()
+			{
+				PET_CHECK(++_depth <= Json::MaxDepth, MakeError("Too deeply nested"));
+			}
+
+			ValuePtr ParseValue()
+			{
+				PET_CHECK(_current != _end, MakeError("Unexpected end of input"));
+
+				switch (*_current)
+				{
+				case '{':
+					return ParseObject();
+				case '[':
+					return ParseArray();
+				case '"':
+					return std::make_shared<Value>(ParseString());
+				case 't':
+					return ExpectLiteral("true", TrueValue);
+				case 'f':
+					return ExpectLiteral("false", FalseValue);
+				case 'n':
+					return ExpectLiteral("null", NullValue);
+				default:
+					return ParseNumber();
+				}
+			}
+
+			ValuePtr ParseArray()
+			{
+				++_current;
+				Enter();
+
+				// Numbers are kept unboxed for as long as every element has the same number type
+				auto	   kind = ArrayKind::Empty;
+				const auto start = _values.size();
+				const auto numbersStart = _integers.size();
+
+				SkipWhitespace();
+				if (!TryConsume(']'))
+				{
+					do
+					{
+						SkipWhitespace();
+
+						if (kind != ArrayKind::Values && IsAtNumber())
+						{
+							const auto number = ScanNumber();
+							const auto numberKind = number.index() == 0 ? ArrayKind::Integers : ArrayKind::Floats;
+
+							if (kind == ArrayKind::Empty || kind == numberKind)
+							{
+								kind = numberKind;
+								std::visit([this](auto value) { GetNumbers<decltype(value)>().push_back(value); }, number);
+							}
+							else
+							{
+								BoxNumbers(kind, numbersStart);
+								kind = ArrayKind::Values;
+								_values.push_back(Box(number));
+							}
+						}
+						else
+						{
+							if (kind == ArrayKind::Integers || kind == ArrayKind::Floats)
+								BoxNumbers(kind, numbersStart);
+
+							kind = ArrayKind::Values;
+							_values.push_back(ParseValue());
+						}
+
+						SkipWhitespace();
+					} while (TryConsume(','));
+
+					Expect(']');
+				}
+
+				--_depth;
+
+				switch (kind)
+				{
+				case ArrayKind::Integers:
+					return std::make_shared<Value>(std::make_shared<Array>(TakeNumbers<ValueIntegerType>(numbersStart)));
+				case ArrayKind::Floats:
+					return std::make_shared<Value>(std::make_shared<Array>(TakeNumbers<ValueFloatType>(numbersStart)));
+				case ArrayKind::Empty:
+				case ArrayKind::Values:
+				default:
+					break;
+				}
+
+				std::vector<ValuePtr> elements(std::make_move_iterator(_values.begin() + static_cast<ptrdiff_t>(start)),
+											   std::make_move_iterator(_values.end()));
+				_values.resize(start);
+
+				return std::make_shared<Value>(std::make_shared<Array>(std::move(elements)));
+			}
+
+			template <typename T>
+			std::vector<T>& GetNumbers()
+			{
+				if constexpr (std::is_same_v<T, ValueIntegerType>)
+					return _integers;
+				else
+					return _floats;
+			}
+
+			template <typename T>
+			std::vector<T> TakeNumbers(size_t start)
+			{
+				auto&		   numbers = GetNumbers<T>();
+				std::vector<T> result(numbers.begin() + static_cast<ptrdiff_t>(start), numbers.end());
+				numbers.resize(start);
+
+				return result;
+			}
+
+			// Moves the numbers of the current array to the value stack once it turns out to be heterogeneous
+			void BoxNumbers(ArrayKind kind, size_t start)
+			{
+				const auto boxAll = [this, start](auto& numbers)
+				{
+					for (auto i = start; i < numbers.size(); ++i) _values.push_back(std::make_shared<Value>(numbers[i]));
+					numbers.resize(start);
+				};
+
+				if (kind == ArrayKind::Integers)
+					boxAll(_integers);
+				else
+					boxAll(_floats);
+			}
+
+			ValuePtr ParseObject()
+			{
+				++_current;
+				Enter();
+
+				const auto start = _values.size();
+
+				SkipWhitespace();
+				if (!TryConsume('}'))
+				{
+					do
+					{
+						SkipWhitespace();
+						PET_CHECK(_current != _end && *_current == '"', MakeError("Expect string key"));
+						_keys.push_back(ParseString());
+
+						SkipWhitespace();
+						Expect(':');
+						SkipWhitespace();
+
+						_values.push_back(ParseValue());
+						SkipWhitespace();
+					} while (TryConsume(','));
+
+					Expect('}');
+				}
+
+				const auto size = _values.size() - start;
+				const auto keys = _keys.end() - static_cast<ptrdiff_t>(size);
+				const auto values = _values.begin() + static_cast<ptrdiff_t>(start);
+
+				DictionaryPtr dictionary;
+
+				if (const auto shape = FindRecordShape(keys, values, size))
+					dictionary = std::make_shared<Dictionary>(shape, std::vector<ValuePtr>(std::make_move_iterator(values),
+																						   std::make_move_iterator(_values.end())));
+				else
+				{
+					dictionary = std::make_shared<Dictionary>();
+					dictionary->Reserve(size);
+
+					for (size_t i = 0; i < size; ++i) dictionary->Set(std::make_shared<Value>(keys[static_cast<ptrdiff_t>(i)]), values[i]);
+				}
+
+				_keys.erase(keys, _keys.end());
+				_values.resize(start);
+
+				--_depth;
+				return std::make_shared<Value>(std::move(dictionary));
+			}
+
+			// Returns the shape of a record with these keys, or nullptr if the object has to go through the generic path: when it is
+			// too large for a shape, has a duplicate key or a null value, or when data shapes ran out (see Shape::AddDataTransition).
+			// Arrays of records usually repeat the same keys, so the last shape is checked first to skip interning and transitions.
+			Shape* FindRecordShape(std::vector<String>::const_iterator keys, std::vector<ValuePtr>::const_iterator values, size_t size)
+			{
+				if (size == 0 || size > Dictionary::MaxShapeSize)
+					return nullptr;
+
+				for (size_t i = 0; i < size; ++i)
+					if (values[static_cast<ptrdiff_t>(i)]->IsNull())
+						return nullptr;
+
+				if (_recordShape && _recordShape->GetSize() == size &&
+					std::equal(keys, keys + static_cast<ptrdiff_t>(size), _recordShape->GetKeys().begin(),
+							   [](const String& key, const String& shapeKey) { return key.GetView() == shapeKey.GetView(); }))
+					return _recordShape;
+
+				auto shape = Shape::GetRoot();
+				for (size_t i = 0; i < size; ++i)
+				{
+					const auto& key = keys[static_cast<ptrdiff_t>(i)];
+					if (shape->Find(key))
+						return nullptr;
+
+					shape = shape->AddDataTransition(key.GetView(), _interner);
+					if (!shape)
+						return nullptr;
+				}
+
+				return _recordShape = shape;
+			}
+
+			String ParseString()
+			{
+				++_current;
+
+				const auto start = _current;
+				_current = FindStringSpecial(_current, _end);
+
+				if (_current != _end && *_current == '"')
+					return _text.Slice(static_cast<size_t>(start - _begin), static_cast<size_t>(_current++ - start));
+
+				_unescaped.assign(start, _current);
+
+				while (true)
+				{
+					PET_CHECK(_current != _end, MakeError("Unterminated string"));
+
+					if (*_current == '"')
+					{
+						++_current;
+						return String(_unescaped);
+					}
+
+					PET_CHECK(*_current == '\\', MakeError("Control character in string"));
+					ParseEscape();
+
+					const auto run = _current;
+					_current = FindStringSpecial(_current, _end);
+					_unescaped.append(run, _current);
+				}
+			}
+
+			void ParseEscape()
+			{
+				++_current;
+				PET_CHECK(_current != _end, MakeError("Unterminated string"));
+
+				switch (*_current++)
+				{
+				case '"':
+					_unescaped.push_back('"');
+					break;
+				case '\\':
+					_unescaped.push_back('\\');
+					break;
+				case '/':
+					_unescaped.push_back('/');
+					break;
+				case 'b':
+					_unescaped.push_back('\b');
+					break;
+				case 'f':
+					_unescaped.push_back('\f');
+					break;
+				case 'n':
+					_unescaped.push_back('\n');
+					break;
+				case 'r':
+					_unescaped.push_back('\r');
+					break;
+				case 't':
+					_unescaped.push_back('\t');
+					break;
+				case 'u':
+				{
+					const auto escape = _current - 2;
+					auto	   codePoint = ParseHex4();
+
+					// A high surrogate followed by a low one encodes a code point above the basic plane. Surrogates alone have no
+					// UTF-8 encoding.
+					if (codePoint >= 0xD800 && codePoint < 0xE000)
+					{
+						const auto isPaired = codePoint < 0xDC00 && _end - _current >= 6 && _current[0] == '\\' && _current[1] == 'u';
+						if (isPaired)
+						{
+							_current += 2;
+
+							const auto low = ParseHex4();
+							if (low >= 0xDC00 && low < 0xE000)
+								codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+							else
+								codePoint = 0;
+						}
+
+						if (codePoint < 0x10000)
+						{
+							_current = escape;
+							PET_THROW(MakeError("Unpaired surrogate in unicode escape"));
+						}
+					}
+
+					AppendUtf8(_unescaped, codePoint);
+					break;
+				}
+				default:
+					--_current;
+					PET_THROW(MakeError("Invalid escape sequence"));
+				}
+			}
+
+			uint32_t ParseHex4()
+			{
+				uint32_t result = 0;
+				for (size_t i = 0; i < 4; ++i, ++_current)
+				{
+					PET_CHECK(_current != _end, MakeError("Invalid unicode escape"));
+
+					const auto c = *_current;
+					if (c >= '0' && c <= '9')
+						result = result * 16 + static_cast<uint32_t>(c - '0');
+					else if (c >= 'a' && c <= 'f')
+						result = result * 16 + static_cast<uint32_t>(c - 'a' + 10);
+					else if (c >= 'A' && c <= 'F')
+						result = result * 16 + static_cast<uint32_t>(c - 'A' + 10);
+					else
+						PET_THROW(MakeError("Invalid unicode escape"));
+				}
+
+				return result;
+			}
+
+			ValuePtr ParseNumber()
+			{
+				return Box(ScanNumber());
+			}
+
+			bool IsAtNumber() const
+			{
+				return _current != _end && (*_current == '-' || (*_current >= '0' && *_current <= '9'));
+			}
+
+			static ValuePtr Box(const Number& number)
+			{
+				return std::visit([](auto value) { return std::make_shared<Value>(value); }, number);
+			}
+
+			Number ScanNumber()
+			{
+				const auto start = _current;
+				const auto skipDigits = [this]()
+				{
+					const auto digits = _current;
+					while (_current != _end && *_current >= '0' && *_current <= '9') ++_current;
+
+					PET_CHECK(_current != digits, MakeError("Invalid number"));
+				};
+
+				TryConsume('-');
+
+				// A zero integer part is a single digit
+				PET_CHECK(_end - _current < 2 || _current[0] != '0' || _current[1] < '0' || _current[1] > '9',
+						  MakeError("Leading zero in number"));
+				skipDigits();
+
+				auto isInteger = true;
+
+				if (TryConsume('.'))
+				{
+					isInteger = false;
+					skipDigits();
+				}
+
+				if (TryConsume('e') || TryConsume('E'))
+				{
+					isInteger = false;
+					if (!TryConsume('+'))
+						TryConsume('-');
+
+					skipDigits();
+				}
+
+				if (isInteger)
+				{
+					ValueIntegerType value;
+					const auto [end, error] = std::from_chars(start, _current, value);
+					if (error == std::errc())
+						return value;
+				}
+
+				// Fractions, exponents and integers too large for an integer value
+				ValueFloatType value;
+				const auto [end, error] = std::from_chars(start, _current, value);
+				PET_CHECK(error == std::errc(), MakeError("Number out of range"));
+
+				return value;
+			}
+		};
+
+		class Writer
+		{
+		private:
+			std::string& _output;
+
+			// Containers being written, from the outermost one
+			std::vector<const void*> _path;
+
+		public:
+			explicit Writer(std::string& output) : _output(output)
+			{
+			}
+
+			void Write(const Value& value)
+			{
+				value.Visit<void>(
+					[this](const auto& alternative)
+					{
+						using T = std::decay_t<decltype(alternative)>;
+
+						if constexpr (std::is_same_v<ValueNullType, T>)
+							_output.append("null");
+						else if constexpr (std::is_same_v<ValueBooleanType, T>)
+							_output.append(alternative ? "true" : "false");
+						else if constexpr (std::is_same_v<ValueIntegerType, T> || std::is_same_v<ValueFloatType, T>)
+							WriteNumber(alternative);
+						else if constexpr (std::is_same_v<ValueStringType, T>)
+							WriteString(alternative.GetView());
+						else if constexpr (std::is_same_v<ValueFunctionType, T>)
+							PET_THROW(RuntimeError("Cannot write a function as JSON"));
+						else
+							Write(*alternative);
+					});
+			}
+
+		private:
+			void Write(const Array& array)
+			{
+				Enter(&array);
+				_output.push_back('[');
+
+				std::visit(
+					[this](const auto& values)
+					{
+						for (size_t i = 0; i < values.size(); ++i)
+						{
+							if (i != 0)
+								_output.push_back(',');
+
+							if constexpr (std::is_same_v<std::decay_t<decltype(values[i])>, ValuePtr>)
+								Write(*values[i]);
+							else
+								WriteNumber(values[i]);
+						}
+					},
+					array.GetStorage());
+
+				_output.push_back(']');
+				_path.pop_back();
+			}
+
+			void Write(const Dictionary& dictionary)
+			{
+				Enter(&dictionary);
+				_output.push_back('{');
+
+				auto isFirst = true;
+				dictionary.ForEach(
+					[this, &isFirst](const auto& key, const ValuePtr& value)
+					{
+						if (!isFirst)
+							_output.push_back(',');
+
+						isFirst = false;
+
+						// JSON keys are strings, other keys are written as their text
+						if constexpr (std::is_same_v<std::decay_t<decltype(key)>, String>)
+							WriteString(key.GetView());
+						else if (key.IsString())
+							WriteString(key.AsString().GetView());
+						else
+							WriteString(key.ToString());
+
+						_output.push_back(':');
+						Write(*value);
+					});
+
+				_output.push_back('}');
+				_path.pop_back();
+			}
+
+			template <typename T>
+			void WriteNumber(T value)
+			{
+				if constexpr (std::is_floating_point_v<T>)
+					PET_CHECK(std::isfinite(value), RuntimeError(StringBuilder() % "Cannot write " % value % " as JSON"));
+
+				char buffer[NumberUtils::MaxLength];
+				_output.append(buffer, NumberUtils::Format(value, buffer));
+			}
+
+			void WriteString(std::string_view str)
+			{
+				constexpr std::string_view HexDigits = "0123456789abcdef";
+
+				_output.push_back('"');
+
+				auto current = str.data();
+				const auto end = current + str.size();
+
+				while (true)
+				{
+					const auto special = FindStringSpecial(current, end);
+					_output.append(current, special);
+
+					if (special == end)
+						break;
+
+					const auto c = static_cast<unsigned char>(*special);
+					switch (c)
+					{
+					case '"':
+						_output.append("\\\"");
+						break;
+					case '\\':
+						_output.append("\\\\");
+						break;
+					case '\n':
+						_output.append("\\n");
+						break;
+					case '\r':
+						_output.append("\\r");
+						break;
+					case '\t':
+						_output.append("\\t");
+						break;
+					default:
+						_output.append("\\u00");
+						_output.push_back(HexDigits[c >> 4]);
+						_output.push_back(HexDigits[c & 0xF]);
+						break;
+					}
+
+					current = special + 1;
+				}
+
+				_output.push_back('"');
+			}
+
+			void Enter(const void* container)
+			{
+				PET_CHECK(std::find(_path.begin(), _path.end(), container) == _path.end(),
+						  RuntimeError("Cannot write a value containing itself as JSON"));
+				PET_CHECK(_path.size() < Json::MaxDepth, RuntimeError("Cannot write a value this deeply nested as JSON"));
+
+				_path.push_back(container);
+			}
+		};
+	}
+
+	ValuePtr Json::Parse(const String& text, StringInterner& interner)
+	{
+		return Parser(text, interner).ParseDocument();
+	}
+
+	void Json::Write(std::string& output, const Value& value)
+	{
+		Writer(output).Write(value);
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <pet/runtime/Value.hpp>
+
+#include <string>
+
+namespace pet
+{
+	// JSON text to values and back. Objects become dictionaries (a null member is dropped, as null is the absent value of a
+	// dictionary), arrays become arrays and numbers without a fraction or an exponent become integers when they fit.
+	struct Json
+	{
+		static constexpr size_t MaxDepth = 256;
+
+		// Strings without escapes are returned as slices of text. Keys of small objects are interned with interner, so records
+		// sharing their keys also share a dictionary shape.
+		static ValuePtr Parse(const String& text, StringInterner& interner);
+
+		// Appends the compact JSON text of value to output. Functions, non-finite floats, cycles and values nested deeper than
+		// MaxDepth cannot be written.
+		static void Write(std::string& output, const Value& value);
+	};
+}
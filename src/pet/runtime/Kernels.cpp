@@ -0,0 +1,571 @@
+#include <pet/runtime/Kernels.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PET_KERNELS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace pet
+{
+	namespace
+	{
+		// Signed overflow is undefined, so integers are added and multiplied as unsigned
+		ValueIntegerType Add(ValueIntegerType left, ValueIntegerType right)
+		{
+			return static_cast<ValueIntegerType>(static_cast<uint64_t>(left) + static_cast<uint64_t>(right));
+		}
+
+		ValueFloatType Add(ValueFloatType left, ValueFloatType right)
+		{
+			return left + right;
+		}
+
+		ValueIntegerType Multiply(ValueIntegerType left, ValueIntegerType right)
+		{
+			return static_cast<ValueIntegerType>(static_cast<uint64_t>(left) * static_cast<uint64_t>(right));
+		}
+
+		ValueFloatType Multiply(ValueFloatType left, ValueFloatType right)
+		{
+			return left * right;
+		}
+
+		// Same rules as the '==' operator
+		bool IsEqual(ValueIntegerType left, ValueIntegerType right)
+		{
+			return left == right;
+		}
+
+		bool IsEqual(ValueFloatType left, ValueFloatType right)
+		{
+			return std::abs(right - left) <= std::numeric_limits<ValueFloatType>::epsilon();
+		}
+
+		// Min and max return the first NaN they meet, whatever the array length and the kernel picked
+		bool IsNaN(ValueIntegerType)
+		{
+			return false;
+		}
+
+		bool IsNaN(ValueFloatType value)
+		{
+			return std::isnan(value);
+		}
+
+		namespace scalar
+		{
+			template <typename T>
+			T Sum(const T* values, size_t size)
+			{
+				T result = 0;
+				for (size_t i = 0; i < size; ++i) result = pet::Add(result, values[i]);
+
+				return result;
+			}
+
+			template <typename T>
+			T Min(const T* values, size_t size)
+			{
+				auto result = values[0];
+				for (size_t i = 0; i < size; ++i)
+				{
+					if (IsNaN(values[i]))
+						return values[i];
+					if (values[i] < result)
+						result = values[i];
+				}
+
+				return result;
+			}
+
+			template <typename T>
+			T Max(const T* values, size_t size)
+			{
+				auto result = values[0];
+				for (size_t i = 0; i < size; ++i)
+				{
+					if (IsNaN(values[i]))
+						return values[i];
+					if (result < values[i])
+						result = values[i];
+				}
+
+				return result;
+			}
+
+			template <typename T>
+			T Dot(const T* left, const T* right, size_t size)
+			{
+				T result = 0;
+				for (size_t i = 0; i < size; ++i) result = pet::Add(result, pet::Multiply(left[i], right[i]));
+
+				return result;
+			}
+
+			template <typename T>
+			size_t Count(const T* values, size_t size, T value)
+			{
+				size_t result = 0;
+				for (size_t i = 0; i < size; ++i)
+					if (IsEqual(values[i], value))
+						++result;
+
+				return result;
+			}
+
+			template <typename T>
+			void Add(const T* left, const T* right, T* result, size_t size)
+			{
+				for (size_t i = 0; i < size; ++i) result[i] = pet::Add(left[i], right[i]);
+			}
+
+			template <typename T>
+			void Add(const T* left, T right, T* result, size_t size)
+			{
+				for (size_t i = 0; i < size; ++i) result[i] = pet::Add(left[i], right);
+			}
+
+			template <typename T>
+			void Multiply(const T* left, const T* right, T* result, size_t size)
+			{
+				for (size_t i = 0; i < size; ++i) result[i] = pet::Multiply(left[i], right[i]);
+			}
+
+			template <typename T>
+			void Multiply(const T* left, T right, T* result, size_t size)
+			{
+				for (size_t i = 0; i < size; ++i) result[i] = pet::Multiply(left[i], right);
+			}
+
+			template <typename T>
+			void PrefixSum(const T* values, T* result, size_t size)
+			{
+				T sum = 0;
+				for (size_t i = 0; i < size; ++i) result[i] = sum = pet::Add(sum, values[i]);
+			}
+		}
+
+#ifdef PET_KERNELS_AVX2
+		namespace avx2
+		{
+#define PET_AVX2 __attribute__((target("avx2")))
+
+			constexpr size_t Width = 4;
+
+			bool IsSupported()
+			{
+				static const bool isSupported = __builtin_cpu_supports("avx2");
+				return isSupported;
+			}
+
+			PET_AVX2 __m256i Load(const ValueIntegerType* values)
+			{
+				return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+			}
+
+			PET_AVX2 void Store(ValueIntegerType* values, __m256i vector)
+			{
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(values), vector);
+			}
+
+			PET_AVX2 ValueIntegerType Reduce(__m256i vector)
+			{
+				alignas(32) ValueIntegerType lanes[Width];
+				_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), vector);
+				return pet::Add(pet::Add(lanes[0], lanes[1]), pet::Add(lanes[2], lanes[3]));
+			}
+
+			PET_AVX2 ValueFloatType Reduce(__m256d vector)
+			{
+				alignas(32) ValueFloatType lanes[Width];
+				_mm256_store_pd(lanes, vector);
+				return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+			}
+
+			PET_AVX2 ValueIntegerType Sum(const ValueIntegerType* values, size_t size)
+			{
+				auto   first = _mm256_setzero_si256();
+				auto   second = _mm256_setzero_si256();
+				size_t i = 0;
+
+				for (; i + 2 * Width <= size; i += 2 * Width)
+				{
+					first = _mm256_add_epi64(first, Load(values + i));
+					second = _mm256_add_epi64(second, Load(values + i + Width));
+				}
+
+				return pet::Add(Reduce(_mm256_add_epi64(first, second)), scalar::Sum(values + i, size - i));
+			}
+
+			PET_AVX2 ValueFloatType Sum(const ValueFloatType* values, size_t size)
+			{
+				auto   first = _mm256_setzero_pd();
+				auto   second = _mm256_setzero_pd();
+				size_t i = 0;
+
+				for (; i + 2 * Width <= size; i += 2 * Width)
+				{
+					first = _mm256_add_pd(first, _mm256_loadu_pd(values + i));
+					second = _mm256_add_pd(second, _mm256_loadu_pd(values + i + Width));
+				}
+
+				return Reduce(_mm256_add_pd(first, second)) + scalar::Sum(values + i, size - i);
+			}
+
+			PET_AVX2 ValueIntegerType Min(const ValueIntegerType* values, size_t size)
+			{
+				if (size < Width)
+					return scalar::Min(values, size);
+
+				auto   result = Load(values);
+				size_t i = Width;
+
+				for (; i + Width <= size; i += Width)
+				{
+					const auto vector = Load(values + i);
+					result = _mm256_blendv_epi8(result, vector, _mm256_cmpgt_epi64(result, vector));
+				}
+
+				alignas(32) ValueIntegerType lanes[Width];
+				Store(lanes, result);
+
+				auto tail = scalar::Min(lanes, Width);
+				for (; i < size; ++i)
+					if (values[i] < tail)
+						tail = values[i];
+
+				return tail;
+			}
+
+			PET_AVX2 ValueIntegerType Max(const ValueIntegerType* values, size_t size)
+			{
+				if (size < Width)
+					return scalar::Max(values, size);
+
+				auto   result = Load(values);
+				size_t i = Width;
+
+				for (; i + Width <= size; i += Width)
+				{
+					const auto vector = Load(values + i);
+					result = _mm256_blendv_epi8(result, vector, _mm256_cmpgt_epi64(vector, result));
+				}
+
+				alignas(32) ValueIntegerType lanes[Width];
+				Store(lanes, result);
+
+				auto tail = scalar::Max(lanes, Width);
+				for (; i < size; ++i)
+					if (tail < values[i])
+						tail = values[i];
+
+				return tail;
+			}
+
+			PET_AVX2 ValueFloatType Min(const ValueFloatType* values, size_t size)
+			{
+				if (size < Width)
+					return scalar::Min(values, size);
+
+				auto   result = _mm256_loadu_pd(values);
+				auto   unordered = _mm256_cmp_pd(result, result, _CMP_UNORD_Q);
+				size_t i = Width;
+
+				for (; i + Width <= size; i += Width)
+				{
+					const auto vector = _mm256_loadu_pd(values + i);
+					result = _mm256_min_pd(result, vector);
+					unordered = _mm256_or_pd(unordered, _mm256_cmp_pd(vector, vector, _CMP_UNORD_Q));
+				}
+
+				// _mm256_min_pd drops a NaN in its first operand, so the scalar kernel finds the first NaN instead
+				if (_mm256_movemask_pd(unordered) != 0)
+					return scalar::Min(values, size);
+
+				alignas(32) ValueFloatType lanes[Width];
+				_mm256_store_pd(lanes, result);
+
+				auto tail = scalar::Min(lanes, Width);
+				for (; i < size; ++i)
+				{
+					if (IsNaN(values[i]))
+						return values[i];
+					if (values[i] < tail)
+						tail = values[i];
+				}
+
+				return tail;
+			}
+
+			PET_AVX2 ValueFloatType Max(const ValueFloatType* values, size_t size)
+			{
+				if (size < Width)
+					return scalar::Max(values, size);
+
+				auto   result = _mm256_loadu_pd(values);
+				auto   unordered = _mm256_cmp_pd(result, result, _CMP_UNORD_Q);
+				size_t i = Width;
+
+				for (; i + Width <= size; i += Width)
+				{
+					const auto vector = _mm256_loadu_pd(values + i);
+					result = _mm256_max_pd(result, vector);
+					unordered = _mm256_or_pd(unordered, _mm256_cmp_pd(vector, vector, _CMP_UNORD_Q));
+				}
+
+				// _mm256_max_pd drops a NaN in its first operand, so the scalar kernel finds the first NaN instead
+				if (_mm256_movemask_pd(unordered) != 0)
+					return scalar::Max(values, size);
+
+				alignas(32) ValueFloatType lanes[Width];
+				_mm256_store_pd(lanes, result);
+
+				auto tail = scalar::Max(lanes, Width);
+				for (; i < size; ++i)
+				{
+					if (IsNaN(values[i]))
+						return values[i];
+					if (tail < values[i])
+						tail = values[i];
+				}
+
+				return tail;
+			}
+
+			PET_AVX2 ValueFloatType Dot(const ValueFloatType* left, const ValueFloatType* right, size_t size)
+			{
+				auto   result = _mm256_setzero_pd();
+				size_t i = 0;
+
+				for (; i + Width <= size; i += Width)
+					result = _mm256_add_pd(result, _mm256_mul_pd(_mm256_loadu_pd(left + i), _mm256_loadu_pd(right + i)));
+
+				return Reduce(result) + scalar::Dot(left + i, right + i, size - i);
+			}
+
+			PET_AVX2 size_t Count(const ValueIntegerType* values, size_t size, ValueIntegerType value)
+			{
+				const auto broadcast = _mm256_set1_epi64x(value);
+
+				size_t result = 0;
+				size_t i = 0;
+
+				for (; i + Width <= size; i += Width)
+				{
+					const auto mask = _mm256_castsi256_pd(_mm256_cmpeq_epi64(Load(values + i), broadcast));
+					result += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(_mm256_movemask_pd(mask))));
+				}
+
+				return result + scalar::Count(values + i, size - i, value);
+			}
+
+			PET_AVX2 size_t Count(const ValueFloatType* values, size_t size, ValueFloatType value)
+			{
+				const auto broadcast = _mm256_set1_pd(value);
+				const auto signMask = _mm256_set1_pd(-0.0);
+				const auto epsilon = _mm256_set1_pd(std::numeric_limits<ValueFloatType>::epsilon());
+
+				size_t result = 0;
+				size_t i = 0;
+
+				for (; i + Width <= size; i += Width)
+				{
+					const auto distance = _mm256_andnot_pd(signMask, _mm256_sub_pd(broadcast, _mm256_loadu_pd(values + i)));
+					const auto mask = _mm256_cmp_pd(distance, epsilon, _CMP_LE_OQ);
+					result += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(_mm256_movemask_pd(mask))));
+				}
+
+				return result + scalar::Count(values + i, size - i, value);
+			}
+
+			PET_AVX2 void Add(const ValueIntegerType* left, const ValueIntegerType* right, ValueIntegerType* result, size_t size)
+			{
+				size_t i = 0;
+				for (; i + Width <= size; i += Width) Store(result + i, _mm256_add_epi64(Load(left + i), Load(right + i)));
+
+				scalar::Add(left + i, right + i, result + i, size - i);
+			}
+
+			PET_AVX2 void Add(const ValueIntegerType* left, ValueIntegerType right, ValueIntegerType* result, size_t size)
+			{
+				const auto broadcast = _mm256_set1_epi64x(right);
+
+				size_t i = 0;
+				for (; i + Width <= size; i += Width) Store(result + i, _mm256_add_epi64(Load(left + i), broadcast));
+
+				scalar::Add(left + i, right, result + i, size - i);
+			}
+
+			PET_AVX2 void Add(const ValueFloatType* left, const ValueFloatType* right, ValueFloatType* result, size_t size)
+			{
+				size_t i = 0;
+				for (; i + Width <= size; i += Width)
+					_mm256_storeu_pd(result + i, _mm256_add_pd(_mm256_loadu_pd(left + i), _mm256_loadu_pd(right + i)));
+
+				scalar::Add(left + i, right + i, result + i, size - i);
+			}
+
+			PET_AVX2 void Add(const ValueFloatType* left, ValueFloatType right, ValueFloatType* result, size_t size)
+			{
+				const auto broadcast = _mm256_set1_pd(right);
+
+				size_t i = 0;
+				for (; i + Width <= size; i += Width) _mm256_storeu_pd(result + i, _mm256_add_pd(_mm256_loadu_pd(left + i), broadcast));
+
+				scalar::Add(left + i, right, result + i, size - i);
+			}
+
+			PET_AVX2 void Multiply(const ValueFloatType* left, const ValueFloatType* right, ValueFloatType* result, size_t size)
+			{
+				size_t i = 0;
+				for (; i + Width <= size; i += Width)
+					_mm256_storeu_pd(result + i, _mm256_mul_pd(_mm256_loadu_pd(left + i), _mm256_loadu_pd(right + i)));
+
+				scalar::Multiply(left + i, right + i, result + i, size - i);
+			}
+
+			PET_AVX2 void Multiply(const ValueFloatType* left, ValueFloatType right, ValueFloatType* result, size_t size)
+			{
+				const auto broadcast = _mm256_set1_pd(right);
+
+				size_t i = 0;
+				for (; i + Width <= size; i += Width) _mm256_storeu_pd(result + i, _mm256_mul_pd(_mm256_loadu_pd(left + i), broadcast));
+
+				scalar::Multiply(left + i, right, result + i, size - i);
+			}
+
+			// In-register scan: add the vector shifted by one lane, then by two, then the carry from the previous block
+			PET_AVX2 void PrefixSum(const ValueIntegerType* values, ValueIntegerType* result, size_t size)
+			{
+				const auto zero = _mm256_setzero_si256();
+
+				auto   carry = zero;
+				size_t i = 0;
+
+				for (; i + Width <= size; i += Width)
+				{
+					auto vector = Load(values + i);
+					vector = _mm256_add_epi64(vector, _mm256_blend_epi32(_mm256_permute4x64_epi64(vector, 0x90), zero, 0x03));
+					vector = _mm256_add_epi64(vector, _mm256_blend_epi32(_mm256_permute4x64_epi64(vector, 0x40), zero, 0x0F));
+					vector = _mm256_add_epi64(vector, carry);
+
+					Store(result + i, vector);
+					carry = _mm256_permute4x64_epi64(vector, 0xFF);
+				}
+
+				auto sum = i != 0 ? result[i - 1] : 0;
+				for (; i < size; ++i) result[i] = sum = pet::Add(sum, values[i]);
+			}
+
+			PET_AVX2 void PrefixSum(const ValueFloatType* values, ValueFloatType* result, size_t size)
+			{
+				const auto zero = _mm256_setzero_pd();
+
+				auto   carry = zero;
+				size_t i = 0;
+
+				for (; i + Width <= size; i += Width)
+				{
+					auto vector = _mm256_loadu_pd(values + i);
+					vector = _mm256_add_pd(vector, _mm256_blend_pd(_mm256_permute4x64_pd(vector, 0x90), zero, 0x1));
+					vector = _mm256_add_pd(vector, _mm256_blend_pd(_mm256_permute4x64_pd(vector, 0x40), zero, 0x3));
+					vector = _mm256_add_pd(vector, carry);
+
+					_mm256_storeu_pd(result + i, vector);
+					carry = _mm256_permute4x64_pd(vector, 0xFF);
+				}
+
+				auto sum = i != 0 ? result[i - 1] : 0.0;
+				for (; i < size; ++i) result[i] = sum = sum + values[i];
+			}
+
+#undef PET_AVX2
+		}
+#endif
+	}
+
+#ifdef PET_KERNELS_AVX2
+#define PET_DISPATCH(Name, ...) return avx2::IsSupported() ? avx2::Name(__VA_ARGS__) : scalar::Name(__VA_ARGS__)
+#else
+#define PET_DISPATCH(Name, ...) return scalar::Name(__VA_ARGS__)
+#endif
+
+	template <typename T>
+	T Kernels<T>::Sum(const T* values, size_t size)
+	{
+		PET_DISPATCH(Sum, values, size);
+	}
+
+	template <typename T>
+	T Kernels<T>::Min(const T* values, size_t size)
+	{
+		PET_DISPATCH(Min, values, size);
+	}
+
+	template <typename T>
+	T Kernels<T>::Max(const T* values, size_t size)
+	{
+		PET_DISPATCH(Max, values, size);
+	}
+
+	template <typename T>
+	T Kernels<T>::Dot(const T* left, const T* right, size_t size)
+	{
+		// AVX2 has no 64-bit integer multiplication
+		if constexpr (std::is_same_v<ValueIntegerType, T>)
+			return scalar::Dot(left, right, size);
+		else
+			PET_DISPATCH(Dot, left, right, size);
+	}
+
+	template <typename T>
+	size_t Kernels<T>::Count(const T* values, size_t size, T value)
+	{
+		PET_DISPATCH(Count, values, size, value);
+	}
+
+	template <typename T>
+	void Kernels<T>::Add(const T* left, const T* right, T* result, size_t size)
+	{
+		PET_DISPATCH(Add, left, right, result, size);
+	}
+
+	template <typename T>
+	void Kernels<T>::Add(const T* left, T right, T* result, size_t size)
+	{
+		PET_DISPATCH(Add, left, right, result, size);
+	}
+
+	template <typename T>
+	void Kernels<T>::Multiply(const T* left, const T* right, T* result, size_t size)
+	{
+		if constexpr (std::is_same_v<ValueIntegerType, T>)
+			scalar::Multiply(left, right, result, size);
+		else
+			PET_DISPATCH(Multiply, left, right, result, size);
+	}
+
+	template <typename T>
+	void Kernels<T>::Multiply(const T* left, T right, T* result, size_t size)
+	{
+		if constexpr (std::is_same_v<ValueIntegerType, T>)
+			scalar::Multiply(left, right, result, size);
+		else
+			PET_DISPATCH(Multiply, left, right, result, size);
+	}
+
+	template <typename T>
+	void Kernels<T>::PrefixSum(const T* values, T* result, size_t size)
+	{
+		PET_DISPATCH(PrefixSum, values, result, size);
+	}
+
+#undef PET_DISPATCH
+
+	template struct Kernels<ValueIntegerType>;
+	template struct Kernels<ValueFloatType>;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <pet/runtime/Value.hpp>
+
+#include <cstddef>
+
+namespace pet
+{
+	// Numeric kernels over contiguous buffers, used by the array builtins. On x86 an AVX2 version is picked at run time when the
+	// CPU supports it. Integers are added and multiplied as unsigned, so they wrap around on overflow, while the signed arithmetic
+	// of the interpreter is undefined then: results only match a script loop when nothing overflows. Float reductions are not
+	// evaluated left to right, so their last bits may differ from a script loop.
+	template <typename T>
+	struct Kernels
+	{
+		static T	  Sum(const T* values, size_t size);
+		static T	  Min(const T* values, size_t size);
+		static T	  Max(const T* values, size_t size);
+		static T	  Dot(const T* left, const T* right, size_t size);
+		static size_t Count(const T* values, size_t size, T value);
+
+		static void Add(const T* left, const T* right, T* result, size_t size);
+		static void Add(const T* left, T right, T* result, size_t size);
+		static void Multiply(const T* left, const T* right, T* result, size_t size);
+		static void Multiply(const T* left, T right, T* result, size_t size);
+		static void PrefixSum(const T* values, T* result, size_t size);
+	};
+
+	extern template struct Kernels<ValueIntegerType>;
+	extern template struct Kernels<ValueFloatType>;
+}
@@ -0,0 +1,34 @@
+#include <pet/runtime/Object.hpp>
+
+#include <pet/Error.hpp>
+
+namespace pet
+{
+	namespace
+	{
+		thread_local size_t CurrentOwnerId = 0;
+	}
+
+	Object::Object() : _ownerId(CurrentOwnerId)
+	{
+	}
+
+	size_t Object::GetCurrentOwnerId()
+	{
+		return CurrentOwnerId;
+	}
+
+	size_t Object::SetCurrentOwnerId(size_t ownerId)
+	{
+		const auto previous = CurrentOwnerId;
+		CurrentOwnerId = ownerId;
+
+		return previous;
+	}
+
+	void Object::CheckIsWritable(std::string_view what) const
+	{
+		PET_CHECK(CurrentOwnerId == 0 || CurrentOwnerId == _ownerId,
+				  RuntimeError(StringBuilder() % "Cannot modify captured " % what % " from another thread"));
+	}
+}
@@ -2,14 +2,45 @@
 
 #include <pet/runtime/Value.hpp>
 
+#include <string_view>
+
 namespace pet
 {
-	struct Object
+	// Arrays and dictionaries belong to the interpreter that created them. An interpreter forked for another thread only modifies
+	// its own objects: the other ones it reaches may be read by other threads at the same time, so they are read-only to it. The
+	// main interpreter, with id 0, modifies any object.
+	class Object
 	{
+	private:
+		size_t _ownerId;
+
+	public:
+		Object();
 		virtual ~Object() = default;
 
 		virtual void	 Set(const ValuePtr& key, const ValuePtr& value) = 0;
 		virtual ValuePtr Get(const ValuePtr& key) const = 0;
+
+		size_t GetOwnerId() const
+		{
+			return _ownerId;
+		}
+
+		// Gives the object to another interpreter once its owner is done with it
+		void SetOwnerId(size_t ownerId)
+		{
+			_ownerId = ownerId;
+		}
+
+		// Id of the interpreter running on the calling thread, which owns the objects created meanwhile
+		static size_t GetCurrentOwnerId();
+
+		// Returns the previous id, to be restored when the interpreter is done
+		static size_t SetCurrentOwnerId(size_t ownerId);
+
+	protected:
+		// Throws unless the interpreter running on the calling thread may modify the object, which is named what in the error
+		void CheckIsWritable(std::string_view what) const;
 	};
 	PET_DECLARE_PTR(Object);
 }
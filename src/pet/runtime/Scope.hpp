@@ -27,11 +27,19 @@ namespace pet
 
 	private:
 		ScopePtr _parent;
+		size_t	 _ownerId;
+		ScopePtr _original;
 
 		std::unordered_map<StringPoolId, ValueEntry> _values;
 
 	public:
-		explicit Scope(const ScopePtr& parent = nullptr) : _parent(parent)
+		explicit Scope(const ScopePtr& parent = nullptr, size_t ownerId = 0) : _parent(parent), _ownerId(ownerId)
+		{
+		}
+
+		// An empty scope to copy the variables of original into
+		Scope(const ScopePtr& parent, size_t ownerId, const ScopePtr& original)
+			: _parent(parent), _ownerId(ownerId), _original(original->_original ? original->_original : original)
 		{
 		}
 
@@ -40,6 +48,18 @@ namespace pet
 			return _parent;
 		}
 
+		// Id of the interpreter that created the scope
+		size_t GetOwnerId() const
+		{
+			return _ownerId;
+		}
+
+		// The scope this one was copied from, itself if it is not a copy
+		const Scope* GetOriginal() const
+		{
+			return _original ? _original.get() : this;
+		}
+
 		bool Has(StringPoolId id) const
 		{
 			return _values.find(id) != _values.end();
@@ -59,5 +79,17 @@ namespace pet
 			const auto it = _values.find(id);
 			return it == _values.end() ? nullptr : it->second.Value;
 		}
+
+		size_t GetSize() const
+		{
+			return _values.size();
+		}
+
+		// Calls func(id, value, isConst) for every variable declared in the scope, in no particular order
+		template <typename F>
+		void ForEach(F&& func) const
+		{
+			for (const auto& [id, entry] : _values) func(id, entry.Value, entry.IsConst);
+		}
 	};
 }
@@ -0,0 +1,493 @@
+#include <pet/runtime/Serializer.hpp>
+
+#include <pet/runtime/Array.hpp>
+#include <pet/runtime/Dictionary.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace pet
+{
+	static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Floats are encoded in host byte order, which must be little-endian");
+
+	enum class SerialTag : uint8_t
+	{
+		Null,
+		False,
+		True,
+		Integer,
+		Float,
+		String,
+		Array,
+		IntegerArray,
+		FloatArray,
+		// Hash mode dictionary: count, then key and value pairs
+		Dictionary,
+		// Shape mode dictionary: shape index, keys if the shape is new, then values
+		Record,
+		// Index of an object already written, in the order they were first written
+		Reference,
+		// Interned again when read, so that it keeps working as a record key without a lookup
+		InternedString,
+		// Followed by whatever the writer encodes functions as
+		Function
+	};
+
+	namespace
+	{
+		using Tag = SerialTag;
+
+		constexpr std::string_view Magic = "PET\x01";
+
+		uint64_t ZigZagEncode(ValueIntegerType value)
+		{
+			return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+		}
+
+		ValueIntegerType ZigZagDecode(uint64_t value)
+		{
+			return static_cast<ValueIntegerType>((value >> 1) ^ (~(value & 1) + 1));
+		}
+	}
+
+	void Serializer::Serialize(std::string& output, const Value& value)
+	{
+		SerialWriter writer(output);
+
+		writer.WriteBytes(Magic.data(), Magic.size());
+		writer.Write(value);
+	}
+
+	ValuePtr Serializer::Deserialize(const String& bytes, StringInterner& interner)
+	{
+		SerialReader reader(bytes, interner);
+		PET_CHECK(bytes.GetView().substr(0, Magic.size()) == Magic, reader.MakeError("Not a serialized value"));
+
+		reader.ReadBytes(Magic.size());
+
+		auto result = reader.Read();
+		PET_CHECK(reader.IsEnd(), reader.MakeError("Unexpected bytes after the value"));
+
+		return result;
+	}
+
+	SerialWriter::SerialWriter(std::string& output) : _output(output), _size(output.size()), _depth(0)
+	{
+		// Grows geometrically and is cut to size once, so that writes are plain stores into preallocated memory
+		_output.resize(std::max<size_t>(_output.size() * 2, 4096));
+	}
+
+	SerialWriter::~SerialWriter()
+	{
+		_output.resize(_size);
+	}
+
+	void SerialWriter::Write(const Value& value)
+	{
+		value.Visit<void>(
+			[this](const auto& alternative)
+			{
+				using T = std::decay_t<decltype(alternative)>;
+
+				if constexpr (std::is_same_v<ValueNullType, T>)
+					WriteTag(Tag::Null);
+				else if constexpr (std::is_same_v<ValueBooleanType, T>)
+					WriteTag(alternative ? Tag::True : Tag::False);
+				else if constexpr (std::is_same_v<ValueIntegerType, T>)
+				{
+					WriteTag(Tag::Integer);
+					WriteVarint(ZigZagEncode(alternative));
+				}
+				else if constexpr (std::is_same_v<ValueFloatType, T>)
+				{
+					WriteTag(Tag::Float);
+					WriteBytes(&alternative, sizeof(alternative));
+				}
+				else if constexpr (std::is_same_v<ValueStringType, T>)
+				{
+					WriteTag(alternative.IsInterned() ? Tag::InternedString : Tag::String);
+					WriteString(alternative.GetView());
+				}
+				else if (TryWriteReference(alternative.get()))
+				{
+					PET_CHECK(++_depth <= Serializer::MaxDepth, RuntimeError("Cannot serialize a value this deeply nested"));
+
+					if constexpr (std::is_same_v<ValueFunctionType, T>)
+					{
+						WriteTag(Tag::Function);
+						WriteFunction(*alternative);
+					}
+					else
+						Write(*alternative);
+
+					--_depth;
+				}
+			});
+	}
+
+	void SerialWriter::WriteVarint(uint64_t value)
+	{
+		Reserve(MaxScalarSize);
+
+		while (value >= 0x80)
+		{
+			_output[_size++] = static_cast<char>(value | 0x80);
+			value >>= 7;
+		}
+
+		_output[_size++] = static_cast<char>(value);
+	}
+
+	void SerialWriter::WriteString(std::string_view str)
+	{
+		WriteVarint(str.size());
+		WriteBytes(str.data(), str.size());
+	}
+
+	void SerialWriter::WriteBytes(const void* data, size_t size)
+	{
+		// Empty vectors and views may have no data at all
+		if (size == 0)
+			return;
+
+		Reserve(size);
+		std::memcpy(_output.data() + _size, data, size);
+		_size += size;
+	}
+
+	void SerialWriter::WriteFunction(const Function&)
+	{
+		PET_THROW(RuntimeError("Cannot serialize a function"));
+	}
+
+	// Writes a reference to an object already written and returns false, or registers it and returns true
+	bool SerialWriter::TryWriteReference(const void* object)
+	{
+		if (const auto index = _references.Find(object))
+		{
+			WriteTag(Tag::Reference);
+			WriteVarint(*index);
+			return false;
+		}
+
+		_references.InsertOrAssign(object, _references.GetSize());
+		return true;
+	}
+
+	void SerialWriter::Write(const Array& array)
+	{
+		std::visit(
+			[this](const auto& values)
+			{
+				using T = typename std::decay_t<decltype(values)>::value_type;
+
+				if constexpr (std::is_same_v<T, ValueIntegerType>)
+				{
+					WriteTag(Tag::IntegerArray);
+					WriteVarint(values.size());
+					for (const auto value : values) WriteVarint(ZigZagEncode(value));
+				}
+				else if constexpr (std::is_same_v<T, ValueFloatType>)
+				{
+					WriteTag(Tag::FloatArray);
+					WriteVarint(values.size());
+					WriteBytes(values.data(), values.size() * sizeof(T));
+				}
+				else
+				{
+					WriteTag(Tag::Array);
+					WriteVarint(values.size());
+					for (const auto& value : values) Write(*value);
+				}
+			},
+			array.GetStorage());
+	}
+
+	void SerialWriter::Write(const Dictionary& dictionary)
+	{
+		if (const auto shape = dictionary.GetShape())
+		{
+			WriteTag(Tag::Record);
+
+			if (const auto index = _shapes.Find(shape))
+				WriteVarint(*index);
+			else
+			{
+				_shapes.InsertOrAssign(shape, _shapes.GetSize());
+
+				WriteVarint(_shapes.GetSize() - 1);
+				WriteVarint(shape->GetSize());
+				for (const auto& key : shape->GetKeys()) WriteString(key.GetView());
+			}
+
+			dictionary.ForEach([this](const auto&, const ValuePtr& value) { Write(*value); });
+			return;
+		}
+
+		size_t count = 0;
+		dictionary.ForEach([&count](const auto&, const auto&) { ++count; });
+
+		WriteTag(Tag::Dictionary);
+		WriteVarint(count);
+
+		dictionary.ForEach(
+			[this](const auto& key, const ValuePtr& value)
+			{
+				Write(key);
+				Write(*value);
+			});
+	}
+
+	void SerialWriter::Write(const String& key)
+	{
+		WriteTag(key.IsInterned() ? Tag::InternedString : Tag::String);
+		WriteString(key.GetView());
+	}
+
+	void SerialWriter::WriteTag(SerialTag tag)
+	{
+		Reserve(1);
+		_output[_size++] = static_cast<char>(tag);
+	}
+
+	void SerialWriter::Reserve(size_t size)
+	{
+		if (_size + size > _output.size())
+			_output.resize(std::max(_output.size() * 2, _size + size));
+	}
+
+	SerialReader::SerialReader(const String& bytes, StringInterner& interner, std::string_view what)
+		: _bytes(bytes), _interner(interner), _what(what), _begin(bytes.GetView().data()), _current(_begin),
+		  _end(_begin + bytes.GetLength()), _depth(0)
+	{
+	}
+
+	ValuePtr SerialReader::Read()
+	{
+		PET_CHECK(++_depth <= Serializer::MaxDepth, MakeError("Too deeply nested"));
+
+		auto result = ReadValue();
+
+		--_depth;
+		return result;
+	}
+
+	uint64_t SerialReader::ReadVarint()
+	{
+		uint64_t result = 0;
+
+		for (unsigned shift = 0; shift < 64; shift += 7)
+		{
+			PET_CHECK(_current != _end, MakeError("Unexpected end of input"));
+
+			const auto byte = static_cast<uint8_t>(*_current++);
+			result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+
+			if ((byte & 0x80) == 0)
+				return result;
+		}
+
+		PET_THROW(MakeError("Invalid varint"));
+	}
+
+	String SerialReader::ReadString()
+	{
+		const auto size = ReadVarint();
+		const auto offset = static_cast<size_t>(_current - _begin);
+
+		ReadBytes(size);
+		return _bytes.Slice(offset, size);
+	}
+
+	std::string_view SerialReader::ReadBytes(size_t size)
+	{
+		PET_CHECK(size <= GetRemainingSize(), MakeError("Unexpected end of input"));
+
+		const auto result = std::string_view(_current, size);
+		_current += size;
+
+		return result;
+	}
+
+	size_t SerialReader::ReadCount(size_t minSize)
+	{
+		const auto count = ReadVarint();
+		PET_CHECK(count <= GetRemainingSize() / minSize, MakeError("Invalid count"));
+
+		return count;
+	}
+
+	RuntimeError SerialReader::MakeError(const std::string& message) const
+	{
+		return RuntimeError(StringBuilder() % "Invalid " % _what % " at offset " % (_current - _begin) % ": " % message);
+	}
+
+	ValuePtr SerialReader::AddReference(ValuePtr value)
+	{
+		_references.push_back(value);
+		return value;
+	}
+
+	ValuePtr SerialReader::ReadFunction()
+	{
+		PET_THROW(MakeError("Functions are not supported"));
+	}
+
+	ValuePtr SerialReader::ReadValue()
+	{
+		PET_CHECK(_current != _end, MakeError("Unexpected end of input"));
+
+		switch (static_cast<Tag>(*_current++))
+		{
+		case Tag::Null:
+			return NullValue;
+		case Tag::False:
+			return FalseValue;
+		case Tag::True:
+			return TrueValue;
+		case Tag::Integer:
+			return std::make_shared<Value>(ZigZagDecode(ReadVarint()));
+		case Tag::Float:
+			return std::make_shared<Value>(ReadFloat());
+		case Tag::String:
+			return std::make_shared<Value>(ReadString());
+		case Tag::InternedString:
+			return std::make_shared<Value>(_interner.Intern(ReadString().GetView()));
+		case Tag::Array:
+			return ReadArray();
+		case Tag::IntegerArray:
+			return ReadIntegerArray();
+		case Tag::FloatArray:
+			return ReadFloatArray();
+		case Tag::Dictionary:
+			return ReadDictionary();
+		case Tag::Record:
+			return ReadRecord();
+		case Tag::Reference:
+		{
+			const auto index = ReadVarint();
+			PET_CHECK(index < _references.size(), MakeError("Invalid reference"));
+
+			return _references[index];
+		}
+		case Tag::Function:
+			return ReadFunction();
+		default:
+			--_current;
+			PET_THROW(MakeError("Invalid tag"));
+		}
+	}
+
+	ValuePtr SerialReader::ReadArray()
+	{
+		const auto array = std::make_shared<Array>(std::vector<ValuePtr>());
+		const auto result = AddReference(std::make_shared<Value>(array));
+
+		std::vector<ValuePtr> values(ReadCount(1));
+		for (auto& value : values) value = Read();
+
+		array->Assign(std::move(values));
+		return result;
+	}
+
+	ValuePtr SerialReader::ReadIntegerArray()
+	{
+		std::vector<ValueIntegerType> values(ReadCount(1));
+		for (auto& value : values) value = ZigZagDecode(ReadVarint());
+
+		return AddReference(std::make_shared<Value>(std::make_shared<Array>(std::move(values))));
+	}
+
+	ValuePtr SerialReader::ReadFloatArray()
+	{
+		std::vector<ValueFloatType> values(ReadCount(sizeof(ValueFloatType)));
+
+		const auto bytes = ReadBytes(values.size() * sizeof(ValueFloatType));
+		if (!bytes.empty())
+			std::memcpy(values.data(), bytes.data(), bytes.size());
+
+		return AddReference(std::make_shared<Value>(std::make_shared<Array>(std::move(values))));
+	}
+
+	ValuePtr SerialReader::ReadDictionary()
+	{
+		const auto dictionary = std::make_shared<Dictionary>();
+		const auto result = AddReference(std::make_shared<Value>(dictionary));
+
+		const auto count = ReadCount(2);
+		dictionary->Reserve(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const auto key = Read();
+			dictionary->Set(key, Read());
+		}
+
+		return result;
+	}
+
+	ValuePtr SerialReader::ReadRecord()
+	{
+		const auto index = ReadVarint();
+		PET_CHECK(index <= _shapes.size(), MakeError("Invalid shape"));
+
+		if (index == _shapes.size())
+			_shapes.push_back(ReadShape());
+
+		const auto shape = _shapes[index].Shape;
+
+		// The record exists before its values are read, so it is filled once they are all known
+		auto	   dictionary = std::make_shared<Dictionary>();
+		const auto result = AddReference(std::make_shared<Value>(dictionary));
+
+		std::vector<ValuePtr> values(shape ? shape->GetSize() : _shapes[index].Keys.size());
+		for (auto& value : values)
+		{
+			value = Read();
+			PET_CHECK(!value->IsNull(), MakeError("Null record value"));
+		}
+
+		// Keys are only looked up now, since reading the values may have added shapes
+		if (shape)
+			*dictionary = Dictionary(shape, std::move(values));
+		else
+			for (size_t i = 0; i < values.size(); ++i) dictionary->Set(_shapes[index].Keys[i], values[i]);
+
+		return result;
+	}
+
+	SerialReader::RecordShape SerialReader::ReadShape()
+	{
+		const auto size = ReadCount(1);
+		PET_CHECK(size <= Dictionary::MaxShapeSize, MakeError("Invalid shape size"));
+
+		std::vector<String> keys;
+		keys.reserve(size);
+
+		RecordShape result{Shape::GetRoot(), {}};
+		for (size_t i = 0; i < size; ++i)
+		{
+			auto key = ReadString();
+			PET_CHECK(std::find(keys.begin(), keys.end(), key) == keys.end(),
+					  MakeError(StringBuilder() % "Duplicate key '" % key.GetView() % "'"));
+
+			if (result.Shape)
+				result.Shape = result.Shape->AddDataTransition(key.GetView(), _interner);
+
+			keys.push_back(std::move(key));
+		}
+
+		if (!result.Shape)
+			for (const auto& key : keys) result.Keys.push_back(std::make_shared<Value>(key));
+
+		return result;
+	}
+
+	ValueFloatType SerialReader::ReadFloat()
+	{
+		ValueFloatType result;
+		std::memcpy(&result, ReadBytes(sizeof(result)).data(), sizeof(result));
+
+		return result;
+	}
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <pet/Error.hpp>
+#include <pet/runtime/Value.hpp>
+
+#include <toolkit/FlatHashMap.hpp>
+
+#include <string>
+
+namespace pet
+{
+	class Array;
+	class Dictionary;
+	class Shape;
+	struct Function;
+
+	enum class SerialTag : uint8_t;
+
+	// Compact tagged binary encoding of values. Integers and lengths are varints, unboxed arrays are written as such, and the
+	// keys of records are written once per shape. An array or a dictionary reached several times is written once and
+	// referenced afterwards, which keeps shared references and cycles intact.
+	struct Serializer
+	{
+		static constexpr size_t MaxDepth = 1024;
+
+		// Appends the encoding of value to output. Functions and values nested deeper than MaxDepth cannot be serialized.
+		static void Serialize(std::string& output, const Value& value);
+
+		// Strings are returned as slices of bytes, keys are interned with interner. Throws on malformed input.
+		static ValuePtr Deserialize(const String& bytes, StringInterner& interner);
+	};
+
+	// Pointers are aligned, so their low bits are mixed into the high ones the hash map probes with
+	struct PointerHasher
+	{
+		size_t operator()(const void* pointer) const
+		{
+			const auto hash = reinterpret_cast<uintptr_t>(pointer) * 0x9E3779B97F4A7C15ull;
+			return static_cast<size_t>(hash ^ (hash >> 32));
+		}
+	};
+
+	// Appends the encoding of values to a string. Derived writers can encode functions, which the plain format rejects.
+	class SerialWriter
+	{
+		PET_NON_COPYABLE(SerialWriter);
+
+		// Large enough for any varint or float
+		static constexpr size_t MaxScalarSize = 10;
+
+	private:
+		std::string& _output;
+		size_t		 _size;
+		size_t		 _depth;
+
+		FlatHashMap<const void*, uint64_t, PointerHasher> _references;
+		FlatHashMap<const void*, uint64_t, PointerHasher> _shapes;
+
+	public:
+		explicit SerialWriter(std::string& output);
+		virtual ~SerialWriter();
+
+		void Write(const Value& value);
+
+		void WriteVarint(uint64_t value);
+		void WriteString(std::string_view str);
+		void WriteBytes(const void* data, size_t size);
+
+	protected:
+		// Called once per function, after it is registered for references. Throws by default.
+		virtual void WriteFunction(const Function& function);
+
+	private:
+		bool TryWriteReference(const void* object);
+
+		void Write(const Array& array);
+		void Write(const Dictionary& dictionary);
+		void Write(const String& key);
+
+		void WriteTag(SerialTag tag);
+
+		void Reserve(size_t size);
+	};
+
+	// Reads values written by SerialWriter from bytes, checking every read against the end of the input
+	class SerialReader
+	{
+		PET_NON_COPYABLE(SerialReader);
+
+		// Shape of the records sharing a shape index, or their keys once data shapes ran out and they take hash mode
+		struct RecordShape
+		{
+			pet::Shape*			  Shape;
+			std::vector<ValuePtr> Keys;
+		};
+
+	private:
+		const String&	 _bytes;
+		StringInterner&	 _interner;
+		std::string_view _what;
+
+		const char* _begin;
+		const char* _current;
+		const char* _end;
+		size_t		_depth;
+
+		std::vector<ValuePtr>	 _references;
+		std::vector<RecordShape> _shapes;
+
+	public:
+		// what names the input in error messages
+		SerialReader(const String& bytes, StringInterner& interner, std::string_view what = "serialized value");
+		virtual ~SerialReader() = default;
+
+		ValuePtr Read();
+
+		uint64_t		 ReadVarint();
+		String			 ReadString();
+		std::string_view ReadBytes(size_t size);
+
+		// Every element takes at least minSize bytes, which bounds what a count can preallocate
+		size_t ReadCount(size_t minSize);
+
+		bool IsEnd() const
+		{
+			return _current == _end;
+		}
+
+		size_t GetOffset() const
+		{
+			return static_cast<size_t>(_current - _begin);
+		}
+
+		StringInterner& GetInterner()
+		{
+			return _interner;
+		}
+
+		RuntimeError MakeError(const std::string& message) const;
+
+	protected:
+		// Objects are registered before their contents are read, so that the contents can refer back to them
+		ValuePtr AddReference(ValuePtr value);
+
+		// Reads what WriteFunction wrote, registering the function first. Throws by default.
+		virtual ValuePtr ReadFunction();
+
+	private:
+		ValuePtr ReadValue();
+
+		ValuePtr	ReadArray();
+		ValuePtr	ReadIntegerArray();
+		ValuePtr	ReadFloatArray();
+		ValuePtr	ReadDictionary();
+		ValuePtr	ReadRecord();
+		RecordShape ReadShape();
+
+		ValueFloatType ReadFloat();
+
+		size_t GetRemainingSize() const
+		{
+			return static_cast<size_t>(_end - _current);
+		}
+	};
+}
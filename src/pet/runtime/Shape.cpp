@@ -0,0 +1,72 @@
+#include <pet/runtime/Shape.hpp>
+
+#include <atomic>
+#include <mutex>
+
+namespace pet
+{
+	namespace
+	{
+		// The transition tree is shared by the interpreters of all threads
+		std::mutex TransitionMutex;
+
+		size_t DataShapeCount = 0;
+
+		std::atomic<uint32_t> NextId{1};
+	}
+
+	Shape::Shape() : _id(NextId++)
+	{
+	}
+
+	Shape* Shape::GetRoot()
+	{
+		static Shape root;
+		return &root;
+	}
+
+	std::optional<size_t> Shape::Find(const String& key) const
+	{
+		for (size_t i = 0; i < _keys.size(); ++i)
+			if (_keys[i] == key)
+				return i;
+
+		return std::nullopt;
+	}
+
+	Shape* Shape::AddTransition(const String& key)
+	{
+		const std::lock_guard lock(TransitionMutex);
+		return DoAddTransition(key);
+	}
+
+	Shape* Shape::AddDataTransition(std::string_view key, StringInterner& interner)
+	{
+		const std::lock_guard lock(TransitionMutex);
+
+		if (const auto interned = interner.Find(key))
+			if (const auto it = _transitions.find(*interned); it != _transitions.end())
+				return it->second.get();
+
+		if (DataShapeCount == MaxDataShapeCount)
+			return nullptr;
+
+		++DataShapeCount;
+		return DoAddTransition(interner.Intern(key));
+	}
+
+	Shape* Shape::DoAddTransition(const String& key)
+	{
+		auto& transition = _transitions[key];
+
+		if (!transition)
+		{
+			transition = std::make_unique<Shape>();
+			transition->_keys.reserve(_keys.size() + 1);
+			transition->_keys = _keys;
+			transition->_keys.emplace_back(key);
+		}
+
+		return transition.get();
+	}
+}
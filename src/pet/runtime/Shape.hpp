@@ -0,0 +1,102 @@
+#pragma once
+
+#include <pet/runtime/String.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace pet
+{
+	// Node of the transition tree shared by all dictionaries: the keys of a shape are its parent's keys plus one
+	class Shape
+	{
+		PET_NON_COPYABLE(Shape);
+
+	public:
+		static constexpr size_t MaxDataShapeCount = 4096;
+
+	private:
+		uint32_t														 _id;
+		std::vector<String>												 _keys;
+		std::unordered_map<String, std::unique_ptr<Shape>, StringHasher> _transitions;
+
+	public:
+		Shape();
+
+		static Shape* GetRoot();
+
+		// Unique and never 0
+		uint32_t GetId() const
+		{
+			return _id;
+		}
+
+		const std::vector<String>& GetKeys() const
+		{
+			return _keys;
+		}
+
+		size_t GetSize() const
+		{
+			return _keys.size();
+		}
+
+		std::optional<size_t> Find(const String& key) const;
+		Shape*				  AddTransition(const String& key);
+
+		// For the records of parsed data (JSON objects, CSV headers, deserialized records), whose keys are not known in advance.
+		// Existing transitions are followed as usual, but keys are only interned and shapes only created while the process has
+		// created fewer than MaxDataShapeCount of them this way. Past that, returns nullptr and the record takes hash mode, so
+		// data with ever new keys cannot grow the interner and the transition tree without bound.
+		Shape* AddDataTransition(std::string_view key, StringInterner& interner);
+
+	private:
+		Shape* DoAddTransition(const String& key);
+	};
+
+	// Per-site cache of the slot a constant key lives at for the shapes seen so far (monomorphic up to polymorphic). The AST it
+	// lives in is shared by the interpreters of all threads, so each entry is a shape id and a slot packed in one atomic word:
+	// threads filling the cache at once never tear an entry, and they agree on the slot of a shape anyway.
+	class InlineCache
+	{
+		static constexpr size_t Capacity = 4;
+
+	private:
+		std::array<std::atomic<uint64_t>, Capacity> _entries;
+
+	public:
+		InlineCache() : _entries()
+		{
+		}
+
+		std::optional<size_t> Find(const Shape* shape) const
+		{
+			for (const auto& entry : _entries)
+			{
+				const auto value = entry.load(std::memory_order_relaxed);
+				if (value == 0)
+					break;
+
+				if (value >> 32 == shape->GetId())
+					return static_cast<size_t>(value & UINT32_MAX);
+			}
+
+			return std::nullopt;
+		}
+
+		void Add(const Shape* shape, size_t slot)
+		{
+			const auto value = static_cast<uint64_t>(shape->GetId()) << 32 | slot;
+
+			for (auto& entry : _entries)
+			{
+				auto expected = uint64_t(0);
+				if (entry.compare_exchange_strong(expected, value, std::memory_order_relaxed) || expected >> 32 == shape->GetId())
+					return;
+			}
+		}
+	};
+}
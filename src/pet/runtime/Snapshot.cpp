@@ -0,0 +1,704 @@
+#include <pet/runtime/Snapshot.hpp>
+
+#include <pet/runtime/Function.hpp>
+#include <pet/runtime/Serializer.hpp>
+
+namespace pet
+{
+	namespace
+	{
+		constexpr std::string_view Magic = "PETS";
+		constexpr std::string_view ProgramMagic = "PETP";
+
+		constexpr uint64_t NoIndex = static_cast<uint64_t>(-1);
+
+		enum class FunctionKind : uint8_t
+		{
+			Native,
+			Script
+		};
+
+		// Writes ASTs, scopes and functions on top of the value encoding. Identifiers, scopes and statement blocks are numbered in
+		// the order they are first written, and the first occurrence of each is followed by its contents.
+		class SnapshotWriter final : public SerialWriter, private ExpressionVisitor, private StatementVisitor
+		{
+		private:
+			const StringPool& _identifiers;
+			Context*		  _parseContext;
+
+			std::vector<uint64_t>							  _identifierIndexes;
+			uint64_t										  _identifierCount;
+			FlatHashMap<const void*, uint64_t, PointerHasher> _scopes;
+			FlatHashMap<const void*, uint64_t, PointerHasher> _bodies;
+			FlatHashMap<const void*, StringPoolId, PointerHasher> _natives;
+
+		public:
+			// With a parse context, bodies not parsed yet are parsed before being written
+			SnapshotWriter(std::string& output, const Globals& globals, const StringPool& identifiers, Context* parseContext = nullptr)
+				: SerialWriter(output), _identifiers(identifiers), _parseContext(parseContext), _identifierCount(0)
+			{
+				for (const auto& [id, value] : globals)
+					if (value->IsFunction())
+						_natives.InsertOrAssign(value->AsFunction().get(), id);
+			}
+
+			// A scope is written as 0 if it is null, as its index plus 2 if it was already written, or as 1 followed by its parent.
+			// Writing the parent may reach the scope itself through a closure, so it is then either defined (0) or referenced
+			// (index plus 1) after the parent.
+			void WriteScope(const ScopePtr& scope)
+			{
+				if (!scope)
+				{
+					WriteVarint(0);
+					return;
+				}
+
+				if (const auto index = _scopes.Find(scope.get()))
+				{
+					WriteVarint(*index + 2);
+					return;
+				}
+
+				WriteVarint(1);
+				WriteScope(scope->GetParent());
+
+				if (const auto index = _scopes.Find(scope.get()))
+				{
+					WriteVarint(*index + 1);
+					return;
+				}
+
+				_scopes.InsertOrAssign(scope.get(), _scopes.GetSize());
+
+				WriteVarint(0);
+				WriteVarint(scope->GetSize());
+
+				scope->ForEach(
+					[this](StringPoolId id, const ValuePtr& value, bool isConst)
+					{
+						WriteIdentifier(id);
+						WriteVarint(isConst ? 1 : 0);
+						Write(*value);
+					});
+			}
+
+			void WriteStatements(const std::vector<StatementUniqPtr>& statements)
+			{
+				WriteVarint(statements.size());
+				for (const auto& statement : statements) WriteStatement(statement);
+			}
+
+		private:
+			void WriteFunction(const Function& function) override
+			{
+				const auto scriptFunction = dynamic_cast<const ScriptFunction*>(&function);
+				if (!scriptFunction)
+				{
+					const auto id = _natives.Find(&function);
+					PET_CHECK(id, RuntimeError(StringBuilder() % "Cannot save function '" % function.GetName() % "' in a snapshot"));
+
+					WriteVarint(static_cast<uint64_t>(FunctionKind::Native));
+					WriteIdentifier(*id);
+					return;
+				}
+
+				WriteVarint(static_cast<uint64_t>(FunctionKind::Script));
+				WriteIdentifier(scriptFunction->Id);
+				WriteIdentifiers(scriptFunction->Parameters);
+				WriteScope(scriptFunction->Closure);
+				WriteBody(scriptFunction->Body);
+			}
+
+			// Identifiers are written as their index, new ones as the next index followed by their text
+			void WriteIdentifier(StringPoolId id)
+			{
+				if (id >= _identifierIndexes.size())
+					_identifierIndexes.resize(id + 1, NoIndex);
+
+				if (_identifierIndexes[id] != NoIndex)
+				{
+					WriteVarint(_identifierIndexes[id]);
+					return;
+				}
+
+				_identifierIndexes[id] = _identifierCount++;
+
+				WriteVarint(_identifierIndexes[id]);
+				WriteString(_identifiers.Get(id));
+			}
+
+			void WriteIdentifiers(const std::vector<StringPoolId>& ids)
+			{
+				WriteVarint(ids.size());
+				for (const auto id : ids) WriteIdentifier(id);
+			}
+
+			// Bodies are shared by the AST and the functions created from it, so they are numbered like scopes. A body which is not
+			// parsed yet is written as its source, unless there is a parse context: it is then parsed first, and only one which
+			// fails to parse keeps its source, so that the error is still reported when it is first called.
+			void WriteBody(const FunctionBodyPtr& body)
+			{
+				if (const auto index = _bodies.Find(body.get()))
+				{
+					WriteVarint(*index);
+					return;
+				}
+
+				_bodies.InsertOrAssign(body.get(), _bodies.GetSize());
+
+				if (_parseContext && !body->IsParsed())
+				{
+					try
+					{
+						body->GetStatements(*_parseContext);
+					}
+					catch (const std::exception&)
+					{
+						// Parsed again, and the error reported, on the first call
+					}
+				}
+
+				WriteVarint(_bodies.GetSize() - 1);
+				if (body->IsParsed())
+				{
+					WriteVarint(0);
+					WriteStatements(body->GetParsedStatements());
+					return;
+				}
+
+				WriteVarint(1);
+				WriteVarint(body->GetLocation().Line);
+				WriteVarint(body->GetLocation().Column);
+				WriteString(body->GetSource());
+			}
+
+			// Kinds are written plus one, so that 0 stands for a missing statement or expression
+			void WriteStatement(const StatementUniqPtr& statement)
+			{
+				if (!statement)
+				{
+					WriteVarint(0);
+					return;
+				}
+
+				WriteVarint(static_cast<uint64_t>(statement->GetKind()) + 1);
+				statement->Visit(*this);
+			}
+
+			void WriteExpression(const ExpressionUniqPtr& expression)
+			{
+				if (!expression)
+				{
+					WriteVarint(0);
+					return;
+				}
+
+				WriteVarint(static_cast<uint64_t>(expression->GetKind()) + 1);
+				expression->Visit(*this);
+			}
+
+			void WriteExpressions(const std::vector<ExpressionUniqPtr>& expressions)
+			{
+				WriteVarint(expressions.size());
+				for (const auto& expression : expressions) WriteExpression(expression);
+			}
+
+			void WriteOperator(TokenKind operator_)
+			{
+				WriteVarint(static_cast<uint64_t>(operator_));
+			}
+
+			void VisitBinary(BinaryExpression& expression) override
+			{
+				WriteExpression(expression.Left);
+				WriteOperator(expression.Operator);
+				WriteExpression(expression.Right);
+			}
+
+			void VisitGrouping(GroupingExpression& expression) override
+			{
+				WriteExpression(expression.Expression);
+			}
+
+			void VisitUnary(UnaryExpression& expression) override
+			{
+				WriteOperator(expression.Operator);
+				WriteExpression(expression.Right);
+			}
+
+			void VisitLiteral(LiteralExpression& expression) override
+			{
+				Write(*expression.Value);
+			}
+
+			void VisitDictionary(DictionaryExpression&) override
+			{
+			}
+
+			void VisitArray(ArrayExpression& expression) override
+			{
+				WriteExpressions(expression.Values);
+			}
+
+			void VisitMember(MemberExpression& expression) override
+			{
+				WriteExpression(expression.Target);
+				WriteExpression(expression.Key);
+			}
+
+			void VisitFunction(FunctionExpression& expression) override
+			{
+				WriteIdentifiers(expression.Parameters);
+				WriteBody(expression.Body);
+			}
+
+			void VisitIdentifier(IdentifierExpression& expression) override
+			{
+				WriteIdentifier(expression.Id);
+			}
+
+			void VisitAssignment(AssignmentExpression& expression) override
+			{
+				WriteExpression(expression.Target);
+				WriteExpression(expression.Value);
+			}
+
+			void VisitLogical(LogicalExpression& expression) override
+			{
+				WriteExpression(expression.Left);
+				WriteOperator(expression.Operator);
+				WriteExpression(expression.Right);
+			}
+
+			void VisitCall(CallExpression& expression) override
+			{
+				WriteExpression(expression.Callee);
+				WriteExpressions(expression.Arguments);
+			}
+
+			void VisitVariableDeclaration(VariableDeclarationStatement& statement) override
+			{
+				WriteIdentifier(statement.Id);
+				WriteExpression(statement.Value);
+				WriteVarint(statement.IsConst ? 1 : 0);
+			}
+
+			void VisitFunctionDeclaration(FunctionDeclarationStatement& statement) override
+			{
+				WriteIdentifier(statement.Id);
+				WriteIdentifiers(statement.Parameters);
+				WriteBody(statement.Body);
+			}
+
+			void VisitExpression(ExpressionStatement& statement) override
+			{
+				WriteExpression(statement.Expression);
+			}
+
+			void VisitBlock(BlockStatement& statement) override
+			{
+				WriteStatements(statement.Statements);
+			}
+
+			void VisitIf(IfStatement& statement) override
+			{
+				WriteExpression(statement.Condition);
+				WriteStatement(statement.StatementTrue);
+				WriteStatement(statement.StatementFalse);
+			}
+
+			void VisitWhile(WhileStatement& statement) override
+			{
+				WriteExpression(statement.Condition);
+				WriteStatement(statement.Body);
+			}
+
+			void VisitBreak(BreakStatement&) override
+			{
+			}
+
+			void VisitReturn(ReturnStatement& statement) override
+			{
+				WriteExpression(statement.Value);
+			}
+
+			void VisitContinue(ContinueStatement&) override
+			{
+			}
+
+			void VisitImport(ImportStatement& statement) override
+			{
+				WriteString(statement.Path);
+			}
+		};
+
+		class SnapshotReader final : public SerialReader
+		{
+		private:
+			StringPool&	   _identifierPool;
+			const Globals& _globals;
+			size_t		   _depth;
+
+			std::vector<StringPoolId>	   _identifiers;
+			std::vector<ScopePtr>		   _scopes;
+			std::vector<FunctionBodyPtr>   _bodies;
+
+		public:
+			SnapshotReader(const String& bytes, Context& context, const Globals& globals)
+				: SerialReader(bytes, context.GetStringInterner(), "snapshot"), _identifierPool(context.GetIdentifierPool()),
+				  _globals(globals), _depth(0)
+			{
+			}
+
+			ScopePtr ReadScope()
+			{
+				const auto index = ReadVarint();
+				if (index == 0)
+					return nullptr;
+
+				if (index > 1)
+				{
+					PET_CHECK(index - 2 < _scopes.size(), MakeError("Invalid scope"));
+					return _scopes[index - 2];
+				}
+
+				const auto parent = ReadScope();
+
+				if (const auto definedIndex = ReadVarint(); definedIndex != 0)
+				{
+					PET_CHECK(definedIndex - 1 < _scopes.size() && _scopes[definedIndex - 1]->GetParent() == parent,
+							  MakeError("Invalid scope"));
+					return _scopes[definedIndex - 1];
+				}
+
+				const auto scope = std::make_shared<Scope>(parent);
+				_scopes.push_back(scope);
+
+				const auto count = ReadCount(3);
+				for (size_t i = 0; i < count; ++i)
+				{
+					const auto id = ReadIdentifier();
+					const auto isConst = ReadFlag();
+
+					PET_CHECK(!scope->Has(id), MakeError("Duplicate variable"));
+					scope->Declare(id, Read(), isConst);
+				}
+
+				return scope;
+			}
+
+			std::vector<StatementUniqPtr> ReadStatements()
+			{
+				std::vector<StatementUniqPtr> statements(ReadCount(1));
+				for (auto& statement : statements)
+				{
+					statement = ReadStatement();
+					PET_CHECK(statement, MakeError("Missing statement"));
+				}
+
+				return statements;
+			}
+
+		private:
+			ValuePtr ReadFunction() override
+			{
+				switch (static_cast<FunctionKind>(ReadVarint()))
+				{
+				case FunctionKind::Native:
+				{
+					const auto id = ReadIdentifier();
+
+					const auto it = _globals.find(id);
+					PET_CHECK(it != _globals.end() && it->second->IsFunction(),
+							  MakeError(StringBuilder() % "Unknown function '" % _identifierPool.Get(id) % "'"));
+
+					return AddReference(it->second);
+				}
+				case FunctionKind::Script:
+				{
+					const auto id = ReadIdentifier();
+
+					const auto function = std::make_shared<ScriptFunction>(nullptr, id, ReadIdentifiers(), nullptr);
+					const auto result = AddReference(std::make_shared<Value>(FunctionPtr(function)));
+
+					function->Closure = ReadScope();
+					function->Body = ReadBody();
+
+					return result;
+				}
+				default:
+					PET_THROW(MakeError("Invalid function"));
+				}
+			}
+
+			StringPoolId ReadIdentifier()
+			{
+				const auto index = ReadVarint();
+				PET_CHECK(index <= _identifiers.size(), MakeError("Invalid identifier"));
+
+				if (index == _identifiers.size())
+					_identifiers.push_back(_identifierPool.Add(ReadString().ToString()));
+
+				return _identifiers[index];
+			}
+
+			std::vector<StringPoolId> ReadIdentifiers()
+			{
+				std::vector<StringPoolId> ids(ReadCount(1));
+				for (auto& id : ids) id = ReadIdentifier();
+
+				return ids;
+			}
+
+			bool ReadFlag()
+			{
+				const auto flag = ReadVarint();
+				PET_CHECK(flag <= 1, MakeError("Invalid flag"));
+
+				return flag == 1;
+			}
+
+			TokenKind ReadOperator()
+			{
+				const auto operator_ = ReadVarint();
+				PET_CHECK(operator_ < static_cast<uint64_t>(TokenKind::EndOfStream), MakeError("Invalid operator"));
+
+				return static_cast<TokenKind>(operator_);
+			}
+
+			FunctionBodyPtr ReadBody()
+			{
+				const auto index = ReadVarint();
+				PET_CHECK(index <= _bodies.size(), MakeError("Invalid function body"));
+
+				if (index == _bodies.size())
+				{
+					_bodies.emplace_back();
+
+					if (ReadFlag())
+					{
+						Location location;
+						location.Line = ReadVarint();
+						location.Column = ReadVarint();
+
+						_bodies[index] = std::make_shared<FunctionBody>(ReadString().ToString(), location);
+					}
+					else
+						_bodies[index] = std::make_shared<FunctionBody>(ReadStatements());
+				}
+
+				PET_CHECK(_bodies[index], MakeError("Invalid function body"));
+				return _bodies[index];
+			}
+
+			std::vector<ExpressionUniqPtr> ReadExpressions()
+			{
+				std::vector<ExpressionUniqPtr> expressions(ReadCount(1));
+				for (auto& expression : expressions) expression = ReadRequiredExpression();
+
+				return expressions;
+			}
+
+			ExpressionUniqPtr ReadRequiredExpression()
+			{
+				auto expression = ReadExpression();
+				PET_CHECK(expression, MakeError("Missing expression"));
+
+				return expression;
+			}
+
+			StatementUniqPtr ReadStatement()
+			{
+				const auto kind = ReadVarint();
+				if (kind == 0)
+					return nullptr;
+
+				PET_CHECK(++_depth <= Serializer::MaxDepth, MakeError("Too deeply nested"));
+
+				auto result = ReadStatement(static_cast<StatementKind>(kind - 1));
+
+				--_depth;
+				return result;
+			}
+
+			StatementUniqPtr ReadStatement(StatementKind kind)
+			{
+				switch (kind)
+				{
+				case StatementKind::VariableDeclaration:
+				{
+					const auto id = ReadIdentifier();
+					auto	   value = ReadExpression();
+
+					return std::make_unique<VariableDeclarationStatement>(id, std::move(value), ReadFlag());
+				}
+				case StatementKind::FunctionDeclaration:
+				{
+					const auto id = ReadIdentifier();
+					auto	   parameters = ReadIdentifiers();
+
+					return std::make_unique<FunctionDeclarationStatement>(id, std::move(parameters), ReadBody());
+				}
+				case StatementKind::Expression:
+					return std::make_unique<ExpressionStatement>(ReadRequiredExpression());
+				case StatementKind::Block:
+					return std::make_unique<BlockStatement>(ReadStatements());
+				case StatementKind::If:
+				{
+					auto condition = ReadRequiredExpression();
+					auto statementTrue = ReadStatement();
+					PET_CHECK(statementTrue, MakeError("Missing statement"));
+
+					return std::make_unique<IfStatement>(std::move(condition), std::move(statementTrue), ReadStatement());
+				}
+				case StatementKind::While:
+				{
+					auto condition = ReadRequiredExpression();
+					auto body = ReadStatement();
+					PET_CHECK(body, MakeError("Missing statement"));
+
+					return std::make_unique<WhileStatement>(std::move(condition), std::move(body));
+				}
+				case StatementKind::Break:
+					return std::make_unique<BreakStatement>();
+				case StatementKind::Return:
+					return std::make_unique<ReturnStatement>(ReadExpression());
+				case StatementKind::Continue:
+					return std::make_unique<ContinueStatement>();
+				case StatementKind::Import:
+					return std::make_unique<ImportStatement>(ReadString().ToString());
+				default:
+					PET_THROW(MakeError("Invalid statement"));
+				}
+			}
+
+			ExpressionUniqPtr ReadExpression()
+			{
+				const auto kind = ReadVarint();
+				if (kind == 0)
+					return nullptr;
+
+				PET_CHECK(++_depth <= Serializer::MaxDepth, MakeError("Too deeply nested"));
+
+				auto result = ReadExpression(static_cast<ExpressionKind>(kind - 1));
+
+				--_depth;
+				return result;
+			}
+
+			ExpressionUniqPtr ReadExpression(ExpressionKind kind)
+			{
+				switch (kind)
+				{
+				case ExpressionKind::Binary:
+				{
+					auto	   left = ReadRequiredExpression();
+					const auto operator_ = ReadOperator();
+
+					return std::make_unique<BinaryExpression>(std::move(left), operator_, ReadRequiredExpression());
+				}
+				case ExpressionKind::Grouping:
+					return std::make_unique<GroupingExpression>(ReadRequiredExpression());
+				case ExpressionKind::Unary:
+				{
+					const auto operator_ = ReadOperator();
+					return std::make_unique<UnaryExpression>(operator_, ReadRequiredExpression());
+				}
+				case ExpressionKind::Literal:
+				{
+					auto expression = std::make_unique<LiteralExpression>(Value());
+
+					expression->Value = Read();
+					return expression;
+				}
+				case ExpressionKind::Dictionary:
+					return std::make_unique<DictionaryExpression>();
+				case ExpressionKind::Array:
+					return std::make_unique<ArrayExpression>(ReadExpressions());
+				case ExpressionKind::Member:
+				{
+					auto target = ReadRequiredExpression();
+					return std::make_unique<MemberExpression>(std::move(target), ReadRequiredExpression());
+				}
+				case ExpressionKind::Function:
+				{
+					auto parameters = ReadIdentifiers();
+					return std::make_unique<FunctionExpression>(std::move(parameters), ReadBody());
+				}
+				case ExpressionKind::Identifier:
+					return std::make_unique<IdentifierExpression>(ReadIdentifier());
+				case ExpressionKind::Assignment:
+				{
+					auto target = ReadRequiredExpression();
+					PET_CHECK(target->GetKind() == ExpressionKind::Member || target->GetKind() == ExpressionKind::Identifier,
+							  MakeError("Invalid assignment target"));
+
+					return std::make_unique<AssignmentExpression>(std::move(target), ReadRequiredExpression());
+				}
+				case ExpressionKind::Logical:
+				{
+					auto	   left = ReadRequiredExpression();
+					const auto operator_ = ReadOperator();
+
+					return std::make_unique<LogicalExpression>(std::move(left), operator_, ReadRequiredExpression());
+				}
+				case ExpressionKind::Call:
+				{
+					auto callee = ReadRequiredExpression();
+					return std::make_unique<CallExpression>(std::move(callee), ReadExpressions());
+				}
+				default:
+					PET_THROW(MakeError("Invalid expression"));
+				}
+			}
+		};
+	}
+
+	void Snapshot::Save(std::string& output, const ScopePtr& scope, const Globals& globals, const StringPool& identifiers)
+	{
+		SnapshotWriter writer(output, globals, identifiers);
+
+		writer.WriteBytes(Magic.data(), Magic.size());
+		writer.WriteVarint(Version);
+		writer.WriteScope(scope);
+	}
+
+	ScopePtr Snapshot::Load(const String& bytes, Context& context, const Globals& globals)
+	{
+		SnapshotReader reader(bytes, context, globals);
+		PET_CHECK(bytes.GetView().substr(0, Magic.size()) == Magic, reader.MakeError("Not a snapshot"));
+
+		reader.ReadBytes(Magic.size());
+		PET_CHECK(reader.ReadVarint() == Version, reader.MakeError("Unsupported version"));
+
+		auto scope = reader.ReadScope();
+		PET_CHECK(scope && !scope->GetParent(), reader.MakeError("Invalid global scope"));
+		PET_CHECK(reader.IsEnd(), reader.MakeError("Unexpected bytes after the snapshot"));
+
+		return scope;
+	}
+
+	void Snapshot::SaveProgram(std::string& output, const StatementBlock& statements, Context& context)
+	{
+		SnapshotWriter writer(output, Globals(), context.GetIdentifierPool(), &context);
+
+		writer.WriteBytes(ProgramMagic.data(), ProgramMagic.size());
+		writer.WriteVarint(Version);
+		writer.WriteStatements(statements);
+	}
+
+	StatementBlock Snapshot::LoadProgram(const String& bytes, Context& context)
+	{
+		const Globals  globals;
+		SnapshotReader reader(bytes, context, globals);
+		PET_CHECK(bytes.GetView().substr(0, ProgramMagic.size()) == ProgramMagic, reader.MakeError("Not a program"));
+
+		reader.ReadBytes(ProgramMagic.size());
+		PET_CHECK(reader.ReadVarint() == Version, reader.MakeError("Unsupported version"));
+
+		auto statements = reader.ReadStatements();
+		PET_CHECK(reader.IsEnd(), reader.MakeError("Unexpected bytes after the program"));
+
+		return statements;
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <pet/runtime/Globals.hpp>
+#include <pet/runtime/Scope.hpp>
+
+#include <pet/Context.hpp>
+#include <pet/Statement.hpp>
+
+#include <string>
+
+namespace pet
+{
+	// Image of the global state of an interpreter: the global scope and everything reachable from it, functions included together
+	// with their closures and ASTs, in the value encoding of Serializer. Identifiers are written as text once and mapped to the
+	// identifier pool of the loading context, and builtins are written by name and bound to its globals again, so the image does
+	// not depend on where or in which process it was created. Loading rebuilds the objects directly, none of the code that
+	// produced them is parsed or executed again.
+	struct Snapshot
+	{
+		// Changes whenever the encoding of values or of the AST does
+		static constexpr uint64_t Version = 2;
+
+		// Appends the image of scope to output. Native functions which are not globals cannot be saved.
+		static void Save(std::string& output, const ScopePtr& scope, const Globals& globals, const StringPool& identifiers);
+
+		// Returns the scope saved in bytes. Strings are slices of bytes, so a mapped file is read in place. Throws on malformed input.
+		static ScopePtr Load(const String& bytes, Context& context, const Globals& globals);
+
+		// Appends the image of a parsed program, the top-level statements of a script. Function bodies not parsed yet are parsed
+		// with context first, so that loading the image parses nothing; one with a syntax error is kept as source and reports it
+		// when first called, as it would without the image.
+		static void SaveProgram(std::string& output, const StatementBlock& statements, Context& context);
+
+		// Returns the statements saved in bytes, with identifiers added to the pool of context. Throws on malformed input.
+		static StatementBlock LoadProgram(const String& bytes, Context& context);
+	};
+}
@@ -0,0 +1,186 @@
+#include <pet/runtime/String.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace pet
+{
+	namespace
+	{
+		void DeleteArray(char* data, size_t)
+		{
+			delete[] data;
+		}
+	}
+
+	StringBuffer::StringBuffer(size_t capacity, bool isInterned)
+		: _data(new char[capacity]), _capacity(capacity), _size(0), _isInterned(isInterned), _release(DeleteArray)
+	{
+	}
+
+	StringBuffer::StringBuffer(char* data, size_t size, ReleaseFunction release)
+		: _data(data), _capacity(size), _size(size), _isInterned(false), _release(release)
+	{
+	}
+
+	StringBuffer::~StringBuffer()
+	{
+		_release(_data, _capacity);
+	}
+
+	bool StringBuffer::TryAppend(size_t offset, std::string_view str)
+	{
+		if (offset + str.size() > _capacity)
+			return false;
+
+		auto expected = offset;
+		if (!_size.compare_exchange_strong(expected, offset + str.size()))
+			return false;
+
+		std::memcpy(_data + offset, str.data(), str.size());
+		return true;
+	}
+
+	String::String() : _offset(0), _length(0), _hash(0)
+	{
+	}
+
+	String::String(std::string_view str)
+		: _buffer(str.empty() ? nullptr : std::make_shared<StringBuffer>(str.size())), _offset(0), _length(0), _hash(0)
+	{
+		if (_buffer && _buffer->TryAppend(0, str))
+			_length = str.size();
+	}
+
+	String::String(const std::string& str) : String(std::string_view(str))
+	{
+	}
+
+	String::String(const StringBufferPtr& buffer) : String(buffer, 0, buffer->GetCapacity())
+	{
+	}
+
+	String::String(const StringBufferPtr& buffer, size_t offset, size_t length)
+		: _buffer(buffer), _offset(offset), _length(length), _hash(0)
+	{
+	}
+
+	String String::Concat(const String& other) const
+	{
+		if (other.IsEmpty())
+			return *this;
+
+		if (IsEmpty())
+			return other;
+
+		return Concat(other.GetView());
+	}
+
+	String String::Concat(std::string_view other) const
+	{
+		if (other.empty())
+			return *this;
+
+		if (IsEmpty())
+			return String(other);
+
+		const auto length = _length + other.size();
+
+		if (_buffer->TryAppend(_offset + _length, other))
+			return String(_buffer, _offset, length);
+
+		// The left operand is the one that keeps growing in accumulation loops, so reserve room proportional to it
+		const auto buffer = std::make_shared<StringBuffer>(std::max(length, _length * 2));
+		buffer->TryAppend(0, GetView());
+		buffer->TryAppend(_length, other);
+
+		return String(buffer, 0, length);
+	}
+
+	String String::Slice(size_t offset, size_t length) const
+	{
+		if (length == 0)
+			return String();
+
+		return String(_buffer, _offset + offset, length);
+	}
+
+	String String::Join(const std::vector<std::string_view>& parts, std::string_view separator)
+	{
+		if (parts.empty())
+			return String();
+
+		auto length = separator.size() * (parts.size() - 1);
+		for (const auto part : parts) length += part.size();
+
+		if (length == 0)
+			return String();
+
+		const auto buffer = std::make_shared<StringBuffer>(length);
+
+		size_t offset = 0;
+		for (size_t i = 0; i < parts.size(); ++i)
+		{
+			if (i != 0)
+			{
+				buffer->TryAppend(offset, separator);
+				offset += separator.size();
+			}
+
+			buffer->TryAppend(offset, parts[i]);
+			offset += parts[i].size();
+		}
+
+		return String(buffer, 0, length);
+	}
+
+	StringInterner& StringInterner::GetInstance()
+	{
+		static StringInterner interner;
+		return interner;
+	}
+
+	String StringInterner::Intern(std::string_view str)
+	{
+		if (str.empty())
+			return String();
+
+		{
+			const std::shared_lock lock(_mutex);
+
+			const auto it = _strings.find(str);
+			if (it != _strings.end())
+				return it->second;
+		}
+
+		const std::unique_lock lock(_mutex);
+
+		const auto it = _strings.find(str);
+		if (it != _strings.end())
+			return it->second;
+
+		const auto buffer = std::make_shared<StringBuffer>(str.size(), true);
+		buffer->TryAppend(0, str);
+
+		String result(buffer, 0, str.size());
+		result.GetHash();
+
+		_strings.emplace(result.GetView(), result);
+		return result;
+	}
+
+	std::optional<String> StringInterner::Find(std::string_view str)
+	{
+		if (str.empty())
+			return String();
+
+		const std::shared_lock lock(_mutex);
+
+		const auto it = _strings.find(str);
+		if (it == _strings.end())
+			return std::nullopt;
+
+		return it->second;
+	}
+}
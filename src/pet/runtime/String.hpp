@@ -0,0 +1,240 @@
+#pragma once
+
+#include <toolkit/Macro.hpp>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace pet
+{
+	class StringBuffer
+	{
+		PET_NON_COPYABLE(StringBuffer);
+
+	public:
+		using ReleaseFunction = void (*)(char* data, size_t size);
+
+	private:
+		char*				_data;
+		size_t				_capacity;
+		std::atomic<size_t> _size;
+		bool				_isInterned;
+		ReleaseFunction		_release;
+
+	public:
+		explicit StringBuffer(size_t capacity, bool isInterned = false);
+
+		// Takes over size bytes of already filled memory, e.g. a file mapping, which release frees. The buffer is full, so
+		// nothing is ever appended to it in place.
+		StringBuffer(char* data, size_t size, ReleaseFunction release);
+
+		~StringBuffer();
+
+		const char* GetData() const
+		{
+			return _data;
+		}
+
+		size_t GetCapacity() const
+		{
+			return _capacity;
+		}
+
+		bool IsInterned() const
+		{
+			return _isInterned;
+		}
+
+		// Claims [offset, offset + str.size()) if offset is the current end of the buffer and the capacity allows it.
+		// Bytes below the end are never modified, so every string sharing the buffer keeps seeing its own contents.
+		bool TryAppend(size_t offset, std::string_view str);
+	};
+	PET_DECLARE_PTR(StringBuffer);
+
+	class String
+	{
+		friend class StringInterner;
+
+	private:
+		StringBufferPtr _buffer;
+		size_t			_offset;
+		size_t			_length;
+
+		// Computed on first use. Strings shared by threads may be hashed by several of them at once, which all store the same value.
+		mutable std::atomic<size_t> _hash;
+
+	public:
+		String();
+		String(std::string_view str);
+		String(const std::string& str);
+
+		String(const String& other)
+			: _buffer(other._buffer), _offset(other._offset), _length(other._length), _hash(other._hash.load(std::memory_order_relaxed))
+		{
+		}
+
+		String(String&& other) noexcept
+			: _buffer(std::move(other._buffer)),
+			  _offset(other._offset),
+			  _length(other._length),
+			  _hash(other._hash.load(std::memory_order_relaxed))
+		{
+		}
+
+		String& operator=(const String& other)
+		{
+			_buffer = other._buffer;
+			_offset = other._offset;
+			_length = other._length;
+			_hash.store(other._hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+			return *this;
+		}
+
+		String& operator=(String&& other) noexcept
+		{
+			_buffer = std::move(other._buffer);
+			_offset = other._offset;
+			_length = other._length;
+			_hash.store(other._hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+			return *this;
+		}
+
+		// Covers the whole contents of a full buffer, such as one wrapping a file mapping
+		explicit String(const StringBufferPtr& buffer);
+
+		bool IsEmpty() const
+		{
+			return _length == 0;
+		}
+
+		size_t GetLength() const
+		{
+			return _length;
+		}
+
+		std::string_view GetView() const
+		{
+			return _buffer ? std::string_view(_buffer->GetData() + _offset, _length) : std::string_view();
+		}
+
+		// Interned strings own their whole (exact-size) buffer. There is one interner per process, so two of them are equal only
+		// if they share it.
+		bool IsInterned() const
+		{
+			return _buffer && _buffer->IsInterned() && _offset == 0 && _length == _buffer->GetCapacity();
+		}
+
+		size_t GetHash() const
+		{
+			auto hash = _hash.load(std::memory_order_relaxed);
+			if (hash == 0)
+			{
+				hash = ComputeHash(GetView());
+				_hash.store(hash, std::memory_order_relaxed);
+			}
+
+			return hash;
+		}
+
+		String Concat(const String& other) const;
+		String Concat(std::string_view other) const;
+
+		// Returns [offset, offset + length) of this string, sharing its buffer instead of copying
+		String Slice(size_t offset, size_t length) const;
+
+		// Joins parts with separator into a buffer allocated once with the exact result size
+		static String Join(const std::vector<std::string_view>& parts, std::string_view separator);
+
+		bool operator==(const String& other) const
+		{
+			if (_buffer == other._buffer && _offset == other._offset)
+				return _length == other._length;
+
+			if (_length != other._length || (IsInterned() && other.IsInterned()))
+				return false;
+
+			const auto hash = _hash.load(std::memory_order_relaxed);
+			const auto otherHash = other._hash.load(std::memory_order_relaxed);
+			if (hash != 0 && otherHash != 0 && hash != otherHash)
+				return false;
+
+			return GetView() == other.GetView();
+		}
+
+		bool operator!=(const String& other) const
+		{
+			return !(*this == other);
+		}
+
+		std::string ToString() const
+		{
+			return std::string(GetView());
+		}
+
+		static size_t ComputeHash(std::string_view str)
+		{
+			const auto hash = std::hash<std::string_view>()(str);
+			return hash != 0 ? hash : 1;
+		}
+
+	private:
+		String(const StringBufferPtr& buffer, size_t offset, size_t length);
+	};
+
+	struct StringHasher
+	{
+		size_t operator()(const String& str) const
+		{
+			return str.GetHash();
+		}
+
+		size_t operator()(std::string_view str) const
+		{
+			return String::ComputeHash(str);
+		}
+	};
+
+	struct StringEqual
+	{
+		bool operator()(const String& left, const String& right) const
+		{
+			return left == right;
+		}
+
+		bool operator()(const String& left, std::string_view right) const
+		{
+			return left.GetView() == right;
+		}
+	};
+
+	// Thread-safe. Interned strings have their hash computed up front, so that threads sharing them never write to them.
+	// The interner is shared by every script of the process, so that an interned key compares by buffer whichever script made
+	// it, and so is the shape tree keyed by interned strings. Both live as long as the process and only grow with the number
+	// of distinct keys, not with the number of scripts. Keys read from data are bounded by Shape::AddDataTransition.
+	class StringInterner
+	{
+		PET_NON_COPYABLE(StringInterner);
+
+	private:
+		std::shared_mutex							 _mutex;
+		std::unordered_map<std::string_view, String> _strings;
+
+		StringInterner() = default;
+
+	public:
+		static StringInterner& GetInstance();
+
+		String Intern(std::string_view str);
+
+		// Returns the interned string equal to str if there is one, without interning it
+		std::optional<String> Find(std::string_view str);
+	};
+}
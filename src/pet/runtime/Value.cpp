@@ -3,34 +3,24 @@
 #include <pet/runtime/Array.hpp>
 #include <pet/runtime/Function.hpp>
 #include <pet/runtime/Dictionary.hpp>
-
-#include <toolkit/StringJoiner.hpp>
+#include <pet/runtime/ValueWriter.hpp>
 
 namespace pet
 {
-	namespace
+	namespace details
 	{
-		struct ValueToStringCaster
+		namespace
 		{
-			template <typename T>
-			std::string operator()(const T& value) const
+			std::array<Value, MaxSmallInteger - MinSmallInteger + 1> MakeSmallIntegers()
 			{
-				if constexpr (std::is_same_v<ValueNullType, T>)
-					return "null";
-				else if constexpr (std::is_same_v<ValueBooleanType, T>)
-					return value ? "true" : "false";
-				else if constexpr (std::is_same_v<ValueIntegerType, T> || std::is_same_v<ValueFloatType, T>)
-					return std::to_string(value);
-				else if constexpr (std::is_same_v<ValueStringType, T>)
-					return value;
-				else if constexpr (std::is_same_v<ValueFunctionType, T>)
-					return StringBuilder() % "<fun " % value->GetName() % ">";
-				else if constexpr (std::is_same_v<ValueDictionaryType, T> || std::is_same_v<ValueArrayType, T>)
-					return value->ToString();
-				else
-					PET_THROW(NotSupportedException());
+				std::array<Value, MaxSmallInteger - MinSmallInteger + 1> result;
+				for (size_t i = 0; i < result.size(); ++i) result[i] = Value(MinSmallInteger + static_cast<ValueIntegerType>(i));
+
+				return result;
 			}
-		};
+		}
+
+		std::array<Value, MaxSmallInteger - MinSmallInteger + 1> SmallIntegerData = MakeSmallIntegers();
 	}
 
 	ValueFunctionType Value::AsFunction() const
@@ -50,6 +40,9 @@ namespace pet
 
 	std::string Value::ToString() const
 	{
-		return Visit<std::string>(ValueToStringCaster());
+		std::string result;
+		ValueWriter<std::string>(result).Write(*this);
+
+		return result;
 	}
 }
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <pet/runtime/String.hpp>
+
 #include <toolkit/Macro.hpp>
 
+#include <array>
 #include <variant>
 
 namespace pet
@@ -19,7 +22,7 @@ namespace pet
 	using ValueBooleanType = bool;
 	using ValueFloatType = double;
 	using ValueIntegerType = long long;
-	using ValueStringType = std::string;
+	using ValueStringType = String;
 	using ValueFunctionType = FunctionPtr;
 	using ValueDictionaryType = DictionaryPtr;
 	using ValueArrayType = ArrayPtr;
@@ -95,7 +98,7 @@ namespace pet
 			return std::get<ValueIntegerType>(*this);
 		}
 
-		const std::string& AsString() const
+		const ValueStringType& AsString() const
 		{
 			return std::get<ValueStringType>(*this);
 		}
@@ -114,9 +117,33 @@ namespace pet
 	};
 	PET_DECLARE_PTR(Value);
 
-	inline const auto NullValue = std::make_shared<Value>();
-	inline const auto TrueValue = std::make_shared<Value>(true);
-	inline const auto FalseValue = std::make_shared<Value>(false);
-	inline const auto ZeroValue = std::make_shared<Value>(0);
-	inline const auto OneValue = std::make_shared<Value>(1);
+	namespace details
+	{
+		inline Value NullValueData;
+		inline Value TrueValueData(true);
+		inline Value FalseValueData(false);
+		inline Value ZeroValueData(0);
+		inline Value OneValueData(1);
+
+		constexpr ValueIntegerType MinSmallInteger = -128;
+		constexpr ValueIntegerType MaxSmallInteger = 1023;
+
+		extern std::array<Value, MaxSmallInteger - MinSmallInteger + 1> SmallIntegerData;
+	}
+
+	// Every thread copies these all the time, so they have no control block: copying them does not touch any shared counter
+	inline const ValuePtr NullValue(ValuePtr(), &details::NullValueData);
+	inline const ValuePtr TrueValue(ValuePtr(), &details::TrueValueData);
+	inline const ValuePtr FalseValue(ValuePtr(), &details::FalseValueData);
+	inline const ValuePtr ZeroValue(ValuePtr(), &details::ZeroValueData);
+	inline const ValuePtr OneValue(ValuePtr(), &details::OneValueData);
+
+	// Boxes value, sharing one of the constants above for the small integers array indices, counters and flags mostly are
+	inline ValuePtr MakeIntegerValue(ValueIntegerType value)
+	{
+		if (value >= details::MinSmallInteger && value <= details::MaxSmallInteger)
+			return ValuePtr(ValuePtr(), &details::SmallIntegerData[static_cast<size_t>(value - details::MinSmallInteger)]);
+
+		return std::make_shared<Value>(value);
+	}
 }
@@ -0,0 +1,133 @@
+#include <pet/runtime/ValueKey.hpp>
+
+#include <pet/runtime/Array.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace pet
+{
+	namespace
+	{
+		constexpr size_t MaxArrayKeyDepth = 64;
+
+		enum class KeyTag : uint64_t
+		{
+			Boolean = 1,
+			Integer,
+			Float,
+			Array
+		};
+
+		size_t Mix(KeyTag tag, uint64_t bits)
+		{
+			auto result = bits + static_cast<uint64_t>(tag) * 0x9E3779B97F4A7C15ull;
+			result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ull;
+			result = (result ^ (result >> 27)) * 0x94D049BB133111EBull;
+			return static_cast<size_t>(result ^ (result >> 31));
+		}
+
+		uint64_t GetFloatBits(ValueFloatType value)
+		{
+			// 0.0 and -0.0 are the same key
+			if (std::fpclassify(value) == FP_ZERO)
+				value = 0.0;
+
+			uint64_t result;
+			std::memcpy(&result, &value, sizeof(result));
+			return result;
+		}
+
+		bool IsValidKey(const Value& value, size_t depth)
+		{
+			if (value.IsBoolean() || value.IsNumber() || value.IsString())
+				return true;
+
+			if (!value.IsArray() || depth == MaxArrayKeyDepth)
+				return false;
+
+			const auto array = value.AsArray();
+			for (ValueIntegerType i = 0; i < array->GetLength(); ++i)
+				if (!IsValidKey(*array->Get(i), depth + 1))
+					return false;
+
+			return true;
+		}
+	}
+
+	bool ValueKey::IsValid(const Value& value)
+	{
+		return IsValidKey(value, 0);
+	}
+
+	Value ValueKey::Freeze(const Value& value)
+	{
+		if (!value.IsArray())
+			return value;
+
+		const auto array = value.AsArray();
+
+		std::vector<ValuePtr> values;
+		values.reserve(static_cast<size_t>(array->GetLength()));
+
+		for (ValueIntegerType i = 0; i < array->GetLength(); ++i) values.emplace_back(std::make_shared<Value>(Freeze(*array->Get(i))));
+
+		return Value(std::make_shared<Array>(std::move(values)));
+	}
+
+	size_t ValueKeyHasher::Combine(size_t seed, size_t hash)
+	{
+		return Mix(KeyTag::Array, seed ^ hash);
+	}
+
+	size_t ValueKeyHasher::operator()(const Value& value) const
+	{
+		if (value.IsString())
+			return value.AsString().GetHash();
+		else if (value.IsInteger())
+			return Mix(KeyTag::Integer, static_cast<uint64_t>(value.AsInteger()));
+		else if (value.IsFloat())
+			return Mix(KeyTag::Float, GetFloatBits(value.AsFloat()));
+		else if (value.IsBoolean())
+			return Mix(KeyTag::Boolean, value.AsBoolean() ? 1 : 0);
+		else if (value.IsArray())
+			return value.AsArray()->GetHash();
+		else
+			PET_THROW(NotSupportedException());
+	}
+
+	bool ValueKeyEqual::operator()(const Value& left, const Value& right) const
+	{
+		if (left.index() != right.index())
+			return false;
+
+		if (left.IsString())
+			return left.AsString() == right.AsString();
+		else if (left.IsInteger())
+			return left.AsInteger() == right.AsInteger();
+		else if (left.IsFloat())
+			return GetFloatBits(left.AsFloat()) == GetFloatBits(right.AsFloat());
+		else if (left.IsBoolean())
+			return left.AsBoolean() == right.AsBoolean();
+		else if (left.IsArray())
+		{
+			const auto leftArray = left.AsArray();
+			const auto rightArray = right.AsArray();
+
+			if (leftArray == rightArray)
+				return true;
+
+			if (leftArray->GetLength() != rightArray->GetLength() || leftArray->GetHash() != rightArray->GetHash())
+				return false;
+
+			for (ValueIntegerType i = 0; i < leftArray->GetLength(); ++i)
+				if (!(*this)(*leftArray->Get(i), *rightArray->Get(i)))
+					return false;
+
+			return true;
+		}
+		else
+			return false;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <pet/runtime/Value.hpp>
+
+namespace pet
+{
+	// Dictionary keys are booleans, numbers, strings and arrays of those, hashed with a type tag so that e.g. 1, 1.0 and "1"
+	// are distinct keys. Strings keep their own (cached) hash, which is what allows lookups by std::string_view
+	struct ValueKey
+	{
+		static bool IsValid(const Value& value);
+
+		// Arrays are copied when stored as keys, so that mutating the original afterwards can't corrupt the dictionary
+		static Value Freeze(const Value& value);
+	};
+
+	struct ValueKeyHasher
+	{
+		size_t operator()(const Value& value) const;
+
+		size_t operator()(std::string_view str) const
+		{
+			return String::ComputeHash(str);
+		}
+
+		static size_t Combine(size_t seed, size_t hash);
+	};
+
+	struct ValueKeyEqual
+	{
+		bool operator()(const Value& left, const Value& right) const;
+
+		bool operator()(const Value& left, std::string_view right) const
+		{
+			return left.IsString() && left.AsString().GetView() == right;
+		}
+	};
+}
@@ -0,0 +1,143 @@
+#include <pet/runtime/ValueWriter.hpp>
+
+#include <pet/runtime/Array.hpp>
+#include <pet/runtime/Dictionary.hpp>
+#include <pet/runtime/Function.hpp>
+
+#include <toolkit/NumberUtils.hpp>
+
+#include <algorithm>
+
+namespace pet
+{
+	template <typename Output>
+	ValueWriter<Output>::ValueWriter(Output& output) : _output(output)
+	{
+	}
+
+	template <typename Output>
+	void ValueWriter<Output>::Write(const Value& value)
+	{
+		value.Visit<void>(
+			[this](const auto& alternative)
+			{
+				using T = std::decay_t<decltype(alternative)>;
+
+				if constexpr (std::is_same_v<ValueNullType, T>)
+					WriteText("null");
+				else if constexpr (std::is_same_v<ValueBooleanType, T>)
+					WriteText(alternative ? "true" : "false");
+				else if constexpr (std::is_same_v<ValueIntegerType, T> || std::is_same_v<ValueFloatType, T>)
+					WriteNumber(alternative);
+				else if constexpr (std::is_same_v<ValueStringType, T>)
+					WriteText(alternative.GetView());
+				else if constexpr (std::is_same_v<ValueFunctionType, T>)
+				{
+					WriteText("<fun ");
+					WriteText(alternative->GetName());
+					WriteText(">");
+				}
+				else
+					Write(*alternative);
+			});
+	}
+
+	template <typename Output>
+	void ValueWriter<Output>::Write(const Array& array)
+	{
+		if (!TryEnter(&array))
+		{
+			WriteText("[...]");
+			return;
+		}
+
+		WriteText("[ ");
+
+		std::visit(
+			[this](const auto& values)
+			{
+				for (size_t i = 0; i < values.size(); ++i)
+				{
+					if (i != 0)
+						WriteText(", ");
+
+					if constexpr (std::is_same_v<std::decay_t<decltype(values[i])>, ValuePtr>)
+						Write(*values[i]);
+					else
+						WriteNumber(values[i]);
+				}
+			},
+			array.GetStorage());
+
+		WriteText(array.GetLength() != 0 ? " ]" : "]");
+		_path.pop_back();
+	}
+
+	template <typename Output>
+	void ValueWriter<Output>::Write(const Dictionary& dictionary)
+	{
+		if (!TryEnter(&dictionary))
+		{
+			WriteText("{...}");
+			return;
+		}
+
+		WriteText("{ ");
+
+		auto isEmpty = true;
+		dictionary.ForEach(
+			[this, &isEmpty](const auto& key, const ValuePtr& value)
+			{
+				if (!isEmpty)
+					WriteText(", ");
+
+				isEmpty = false;
+
+				if constexpr (std::is_same_v<std::decay_t<decltype(key)>, String>)
+					WriteText(key.GetView());
+				else
+					Write(key);
+
+				WriteText(": ");
+				Write(*value);
+			});
+
+		WriteText(isEmpty ? "}" : " }");
+		_path.pop_back();
+	}
+
+	template <typename Output>
+	void ValueWriter<Output>::WriteText(std::string_view text)
+	{
+		if constexpr (std::is_same_v<Output, std::string>)
+			_output.append(text);
+		else
+			_output.Write(text);
+	}
+
+	template <typename Output>
+	template <typename T>
+	void ValueWriter<Output>::WriteNumber(T value)
+	{
+		if constexpr (std::is_same_v<Output, std::string>)
+		{
+			char buffer[NumberUtils::MaxLength];
+			_output.append(buffer, NumberUtils::Format(value, buffer));
+		}
+		else
+			_output.WriteNumber(value);
+	}
+
+	template <typename Output>
+	bool ValueWriter<Output>::TryEnter(const void* container)
+	{
+		if (_path.size() >= MaxDepth || std::find(_path.begin(), _path.end(), container) != _path.end())
+			return false;
+
+		_path.push_back(container);
+		return true;
+	}
+
+	template class ValueWriter<std::string>;
+	template class ValueWriter<OutputBuffer>;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <pet/runtime/Value.hpp>
+
+#include <toolkit/OutputBuffer.hpp>
+
+#include <string>
+#include <vector>
+
+namespace pet
+{
+	// Writes the text form of a value graph into a std::string or an OutputBuffer in a single pass, without building
+	// intermediate strings for nested elements. A container which contains itself, or which is nested deeper than MaxDepth,
+	// is written as "[...]" or "{...}" instead of being expanded.
+	template <typename Output>
+	class ValueWriter
+	{
+		static constexpr size_t MaxDepth = 64;
+
+	private:
+		Output& _output;
+
+		// Containers being written, from the outermost one
+		std::vector<const void*> _path;
+
+	public:
+		explicit ValueWriter(Output& output);
+
+		void Write(const Value& value);
+		void Write(const Array& array);
+		void Write(const Dictionary& dictionary);
+
+	private:
+		void WriteText(std::string_view text);
+
+		template <typename T>
+		void WriteNumber(T value);
+
+		bool TryEnter(const void* container);
+	};
+
+	extern template class ValueWriter<std::string>;
+	extern template class ValueWriter<OutputBuffer>;
+}
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <toolkit/Macro.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace pet
+{
+	// Open-addressing hash map in the spirit of Swiss tables: every bucket has a control byte holding 7 bits of the hash,
+	// and lookups compare a whole group of 16 control bytes at once. Buckets only store indexes into a dense entry vector,
+	// which keeps iteration in insertion order. Erased entries are tombstoned and dropped on the next rehash. Every inserted entry
+	// uses up room, even in a reused bucket, so that entries erased and inserted again eventually trigger a rehash.
+	// Lookups are heterogeneous: any key type accepted by both Hasher and KeyEqual can be used.
+	template <typename K, typename V, typename Hasher, typename KeyEqual = std::equal_to<>>
+	class FlatHashMap
+	{
+		static constexpr size_t GroupSize = 16;
+
+		static constexpr int8_t EmptyControl = -128;
+		static constexpr int8_t DeletedControl = -2;
+
+		static constexpr size_t NoIndex = static_cast<size_t>(-1);
+
+		struct Entry
+		{
+			K	   Key;
+			V	   Value;
+			size_t Hash;
+			bool   IsErased;
+		};
+
+		class Group
+		{
+#ifdef __SSE2__
+		private:
+			__m128i _controls;
+
+		public:
+			explicit Group(const int8_t* controls) : _controls(_mm_loadu_si128(reinterpret_cast<const __m128i*>(controls)))
+			{
+			}
+
+			uint32_t Match(int8_t control) const
+			{
+				return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(control), _controls)));
+			}
+
+			uint32_t MatchEmptyOrDeleted() const
+			{
+				return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), _controls)));
+			}
+#else
+		private:
+			const int8_t* _controls;
+
+		public:
+			explicit Group(const int8_t* controls) : _controls(controls)
+			{
+			}
+
+			uint32_t Match(int8_t control) const
+			{
+				uint32_t result = 0;
+				for (size_t i = 0; i < GroupSize; ++i)
+					if (_controls[i] == control)
+						result |= 1u << i;
+
+				return result;
+			}
+
+			uint32_t MatchEmptyOrDeleted() const
+			{
+				uint32_t result = 0;
+				for (size_t i = 0; i < GroupSize; ++i)
+					if (_controls[i] < -1)
+						result |= 1u << i;
+
+				return result;
+			}
+#endif
+		};
+
+	public:
+		class ConstIterator
+		{
+		private:
+			const Entry* _current;
+			const Entry* _end;
+
+		public:
+			ConstIterator(const Entry* current, const Entry* end) : _current(current), _end(end)
+			{
+				SkipErased();
+			}
+
+			std::pair<const K&, const V&> operator*() const
+			{
+				return {_current->Key, _current->Value};
+			}
+
+			ConstIterator& operator++()
+			{
+				++_current;
+				SkipErased();
+				return *this;
+			}
+
+			bool operator!=(const ConstIterator& other) const
+			{
+				return _current != other._current;
+			}
+
+		private:
+			void SkipErased()
+			{
+				while (_current != _end && _current->IsErased) ++_current;
+			}
+		};
+
+	private:
+		std::vector<int8_t>	  _controls;
+		std::vector<uint32_t> _indexes;
+		std::vector<Entry>	  _entries;
+
+		size_t _size;
+		size_t _growthLeft;
+
+		Hasher	 _hasher;
+		KeyEqual _keyEqual;
+
+	public:
+		FlatHashMap() : _size(0), _growthLeft(0)
+		{
+		}
+
+		size_t GetSize() const
+		{
+			return _size;
+		}
+
+		bool IsEmpty() const
+		{
+			return _size == 0;
+		}
+
+		void Reserve(size_t size)
+		{
+			if (size > _size + _growthLeft)
+				Rehash(size);
+		}
+
+		template <typename KeyLike>
+		const V* Find(const KeyLike& key) const
+		{
+			const auto index = FindIndex(key, _hasher(key));
+			return index != NoIndex ? &_entries[index].Value : nullptr;
+		}
+
+		template <typename KeyLike>
+		V* Find(const KeyLike& key)
+		{
+			const auto index = FindIndex(key, _hasher(key));
+			return index != NoIndex ? &_entries[index].Value : nullptr;
+		}
+
+		void InsertOrAssign(const K& key, V value)
+		{
+			const auto hash = _hasher(key);
+			const auto index = FindIndex(key, hash);
+
+			if (index != NoIndex)
+				_entries[index].Value = std::move(value);
+			else
+				InsertNew(K(key), std::move(value), hash);
+		}
+
+		template <typename KeyLike>
+		bool Erase(const KeyLike& key)
+		{
+			const auto hash = _hasher(key);
+			const auto bucket = FindBucket(key, hash);
+			if (bucket == NoIndex)
+				return false;
+
+			auto& entry = _entries[_indexes[bucket]];
+			entry = Entry{K(), V(), 0, true};
+
+			_controls[bucket] = DeletedControl;
+			--_size;
+
+			return true;
+		}
+
+		ConstIterator begin() const
+		{
+			return ConstIterator(_entries.data(), _entries.data() + _entries.size());
+		}
+
+		ConstIterator end() const
+		{
+			return ConstIterator(_entries.data() + _entries.size(), _entries.data() + _entries.size());
+		}
+
+	private:
+		static size_t H1(size_t hash)
+		{
+			return hash >> 7;
+		}
+
+		static int8_t H2(size_t hash)
+		{
+			return static_cast<int8_t>(hash & 0x7F);
+		}
+
+		static size_t CountTrailingZeros(uint32_t mask)
+		{
+			return static_cast<size_t>(__builtin_ctz(mask));
+		}
+
+		size_t GetGroupCount() const
+		{
+			return _controls.size() / GroupSize;
+		}
+
+		template <typename KeyLike>
+		size_t FindBucket(const KeyLike& key, size_t hash) const
+		{
+			if (_controls.empty())
+				return NoIndex;
+
+			const auto h2 = H2(hash);
+			const auto groupMask = GetGroupCount() - 1;
+
+			auto group = H1(hash) & groupMask;
+
+			// Triangular probing over a power-of-two number of groups visits every group, and the load factor guarantees
+			// at least one empty bucket, so the loop always terminates
+			for (size_t step = 1;; ++step)
+			{
+				const auto	offset = group * GroupSize;
+				const Group controls(&_controls[offset]);
+
+				for (auto mask = controls.Match(h2); mask != 0; mask &= mask - 1)
+				{
+					const auto	bucket = offset + CountTrailingZeros(mask);
+					const auto& entry = _entries[_indexes[bucket]];
+					if (entry.Hash == hash && _keyEqual(entry.Key, key))
+						return bucket;
+				}
+
+				if (controls.Match(EmptyControl) != 0)
+					return NoIndex;
+
+				group = (group + step) & groupMask;
+			}
+		}
+
+		template <typename KeyLike>
+		size_t FindIndex(const KeyLike& key, size_t hash) const
+		{
+			const auto bucket = FindBucket(key, hash);
+			return bucket != NoIndex ? _indexes[bucket] : NoIndex;
+		}
+
+		void InsertNew(K&& key, V&& value, size_t hash)
+		{
+			// Mostly erased entries are compacted into a table sized for the live ones, otherwise the table grows
+			if (_growthLeft == 0)
+				Rehash(_size < _entries.size() / 2 ? _size * 2 + 1 : _entries.size() + 1);
+
+			const auto bucket = FindFreeBucket(hash);
+			--_growthLeft;
+
+			_controls[bucket] = H2(hash);
+			_indexes[bucket] = static_cast<uint32_t>(_entries.size());
+			_entries.push_back(Entry{std::move(key), std::move(value), hash, false});
+
+			++_size;
+		}
+
+		size_t FindFreeBucket(size_t hash) const
+		{
+			const auto groupMask = GetGroupCount() - 1;
+
+			auto group = H1(hash) & groupMask;
+
+			for (size_t step = 1;; ++step)
+			{
+				const auto offset = group * GroupSize;
+				const auto mask = Group(&_controls[offset]).MatchEmptyOrDeleted();
+				if (mask != 0)
+					return offset + CountTrailingZeros(mask);
+
+				group = (group + step) & groupMask;
+			}
+		}
+
+		void Rehash(size_t size)
+		{
+			// Keep the load factor at or below 7/8 and the group count a power of two
+			size_t groupCount = 1;
+			while (groupCount * GroupSize * 7 / 8 < size) groupCount *= 2;
+
+			std::vector<Entry> entries;
+			entries.reserve(groupCount * GroupSize * 7 / 8);
+
+			for (auto& entry : _entries)
+				if (!entry.IsErased)
+					entries.push_back(std::move(entry));
+
+			_controls.assign(groupCount * GroupSize, EmptyControl);
+			_indexes.assign(groupCount * GroupSize, 0);
+			_entries = std::move(entries);
+			_growthLeft = groupCount * GroupSize * 7 / 8 - _entries.size();
+
+			for (size_t i = 0; i < _entries.size(); ++i)
+			{
+				const auto bucket = FindFreeBucket(_entries[i].Hash);
+				_controls[bucket] = H2(_entries[i].Hash);
+				_indexes[bucket] = static_cast<uint32_t>(i);
+			}
+		}
+	};
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <charconv>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace pet
+{
+	// Locale-independent number conversions built on std::from_chars and std::to_chars
+	struct NumberUtils
+	{
+		// Enough for any 64-bit integer and for the shortest form of any double, including the ".0" suffix
+		static constexpr size_t MaxLength = 32;
+
+		// Parses the whole string, allowing surrounding whitespace and a leading '+'. Returns nothing for malformed input and
+		// for integers out of range.
+		template <typename T>
+		static std::optional<T> Parse(std::string_view str)
+		{
+			static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>);
+
+			constexpr std::string_view Whitespaces = " \t\n\r\f\v";
+
+			const auto begin = str.find_first_not_of(Whitespaces);
+			if (begin == std::string_view::npos)
+				return std::nullopt;
+
+			str = str.substr(begin, str.find_last_not_of(Whitespaces) + 1 - begin);
+			if (str[0] == '+' && str.size() > 1 && str[1] != '-')
+				str.remove_prefix(1);
+
+			T value;
+			const auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), value);
+			if (error != std::errc() || end != str.data() + str.size())
+				return std::nullopt;
+
+			return value;
+		}
+
+		// Writes value to buffer, which must hold MaxLength characters, and returns the written length. Floats get the shortest
+		// form that parses back to the same value, with ".0" appended to integral values so they still read as floats.
+		template <typename T>
+		static size_t Format(T value, char* buffer)
+		{
+			static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>);
+
+			const auto end = std::to_chars(buffer, buffer + MaxLength, value).ptr;
+			auto	   length = static_cast<size_t>(end - buffer);
+
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				if (std::string_view(buffer, length).find_first_not_of("-0123456789") == std::string_view::npos)
+				{
+					std::memcpy(buffer + length, ".0", 2);
+					length += 2;
+				}
+			}
+
+			return length;
+		}
+
+		template <typename T>
+		static std::string ToString(T value)
+		{
+			char buffer[MaxLength];
+			return std::string(buffer, Format(value, buffer));
+		}
+	};
+}
@@ -0,0 +1,60 @@
+#include <toolkit/OutputBuffer.hpp>
+
+namespace pet
+{
+	OutputBuffer::OutputBuffer(std::ostream& stream, FlushPolicy policy, size_t capacity)
+		: _stream(stream), _policy(policy), _capacity(capacity)
+	{
+		_buffer.reserve(capacity);
+	}
+
+	OutputBuffer::~OutputBuffer()
+	{
+		Flush();
+	}
+
+	void OutputBuffer::SetFlushPolicy(FlushPolicy policy)
+	{
+		_policy = policy;
+
+		if (_policy == FlushPolicy::Line)
+			Flush();
+		else
+			FlushIfFull();
+	}
+
+	void OutputBuffer::Write(std::string_view str)
+	{
+		// Large strings skip the buffer instead of being copied through it
+		if (_policy != FlushPolicy::Explicit && str.size() >= _capacity)
+		{
+			Flush();
+			_stream.write(str.data(), static_cast<std::streamsize>(str.size()));
+			return;
+		}
+
+		_buffer.append(str);
+		FlushIfFull();
+	}
+
+	void OutputBuffer::EndLine()
+	{
+		_buffer.push_back('\n');
+
+		if (_policy == FlushPolicy::Line)
+			Flush();
+		else
+			FlushIfFull();
+	}
+
+	void OutputBuffer::Flush()
+	{
+		if (!_buffer.empty())
+		{
+			_stream.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+			_buffer.clear();
+		}
+
+		_stream.flush();
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <toolkit/Macro.hpp>
+#include <toolkit/NumberUtils.hpp>
+
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace pet
+{
+	enum class FlushPolicy
+	{
+		// Flush after every line, for interactive terminals
+		Line,
+		// Flush when the buffer is full, for files and pipes
+		Size,
+		// Only flush on Flush(), the buffer grows as needed
+		Explicit
+	};
+
+	// Buffers text written to a stream so that it reaches the stream in large chunks instead of one write per call.
+	// Methods are not synchronized: writers sharing a buffer between threads lock GetMutex() for a whole message.
+	class OutputBuffer
+	{
+		PET_NON_COPYABLE(OutputBuffer);
+
+		static constexpr size_t DefaultCapacity = 64 * 1024;
+
+	private:
+		std::ostream& _stream;
+		FlushPolicy	  _policy;
+		size_t		  _capacity;
+		std::string	  _buffer;
+		std::mutex	  _mutex;
+
+	public:
+		explicit OutputBuffer(std::ostream& stream, FlushPolicy policy = FlushPolicy::Size, size_t capacity = DefaultCapacity);
+		~OutputBuffer();
+
+		FlushPolicy GetFlushPolicy() const
+		{
+			return _policy;
+		}
+
+		void SetFlushPolicy(FlushPolicy policy);
+
+		std::mutex& GetMutex()
+		{
+			return _mutex;
+		}
+
+		void Write(std::string_view str);
+
+		void Write(char c)
+		{
+			_buffer.push_back(c);
+			FlushIfFull();
+		}
+
+		// Formats numbers straight into the buffer, see NumberUtils::Format
+		template <typename T>
+		void WriteNumber(T value)
+		{
+			char chars[NumberUtils::MaxLength];
+			Write(std::string_view(chars, NumberUtils::Format(value, chars)));
+		}
+
+		void EndLine();
+
+		void Flush();
+
+	private:
+		void FlushIfFull()
+		{
+			if (_policy != FlushPolicy::Explicit && _buffer.size() >= _capacity)
+				Flush();
+		}
+	};
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace pet
+{
+	namespace details
+	{
+		constexpr ptrdiff_t InsertionSortThreshold = 24;
+		constexpr ptrdiff_t NintherThreshold = 128;
+		constexpr ptrdiff_t PartialInsertionSortLimit = 8;
+
+		template <typename Iterator, typename Less>
+		void InsertionSort(Iterator begin, Iterator end, Less& less)
+		{
+			if (begin == end)
+				return;
+
+			for (auto current = begin + 1; current != end; ++current)
+			{
+				if (!less(*current, *(current - 1)))
+					continue;
+
+				auto value = std::move(*current);
+				auto hole = current;
+
+				do
+				{
+					*hole = std::move(*(hole - 1));
+					--hole;
+				} while (hole != begin && less(value, *(hole - 1)));
+
+				*hole = std::move(value);
+			}
+		}
+
+		// Same as InsertionSort, but gives up and returns false once too many elements had to be moved
+		template <typename Iterator, typename Less>
+		bool PartialInsertionSort(Iterator begin, Iterator end, Less& less)
+		{
+			if (begin == end)
+				return true;
+
+			ptrdiff_t moves = 0;
+
+			for (auto current = begin + 1; current != end; ++current)
+			{
+				if (!less(*current, *(current - 1)))
+					continue;
+
+				auto value = std::move(*current);
+				auto hole = current;
+
+				do
+				{
+					*hole = std::move(*(hole - 1));
+					--hole;
+				} while (hole != begin && less(value, *(hole - 1)));
+
+				*hole = std::move(value);
+
+				moves += current - hole;
+				if (moves > PartialInsertionSortLimit)
+					return false;
+			}
+
+			return true;
+		}
+
+		template <typename Iterator, typename Less>
+		void Sort2(Iterator first, Iterator second, Less& less)
+		{
+			if (less(*second, *first))
+				std::iter_swap(first, second);
+		}
+
+		template <typename Iterator, typename Less>
+		void Sort3(Iterator first, Iterator second, Iterator third, Less& less)
+		{
+			Sort2(first, second, less);
+			Sort2(second, third, less);
+			Sort2(first, second, less);
+		}
+
+		// Partitions [begin, end) around the pivot stored at begin, elements equal to the pivot go to the right part.
+		// Returns the final pivot position and whether no element had to be swapped.
+		template <typename Iterator, typename Less>
+		std::pair<Iterator, bool> PartitionRight(Iterator begin, Iterator end, Less& less)
+		{
+			auto pivot = std::move(*begin);
+			auto first = begin;
+			auto last = end;
+
+			while (++first < end && less(*first, pivot));
+			while (first < last && !less(*--last, pivot));
+
+			const auto isPartitioned = first >= last;
+
+			while (first < last)
+			{
+				std::iter_swap(first, last);
+
+				while (++first < last && less(*first, pivot));
+				while (--last > first && !less(*last, pivot));
+			}
+
+			const auto pivotPosition = first - 1;
+			*begin = std::move(*pivotPosition);
+			*pivotPosition = std::move(pivot);
+
+			return {pivotPosition, isPartitioned};
+		}
+
+		// Partitions [begin, end) around the pivot stored at begin, elements equal to the pivot go to the left part.
+		// Used when the pivot equals the element preceding the range, so the whole left part is already in place.
+		template <typename Iterator, typename Less>
+		Iterator PartitionLeft(Iterator begin, Iterator end, Less& less)
+		{
+			auto pivot = std::move(*begin);
+			auto first = begin;
+			auto last = end;
+
+			while (--last > begin && less(pivot, *last));
+			while (++first < last && !less(pivot, *first));
+
+			while (first < last)
+			{
+				std::iter_swap(first, last);
+
+				while (--last > first && less(pivot, *last));
+				while (++first < last && !less(pivot, *first));
+			}
+
+			*begin = std::move(*last);
+			*last = std::move(pivot);
+
+			return last;
+		}
+
+		template <typename Iterator, typename Less>
+		void PdqSortLoop(Iterator begin, Iterator end, Less& less, size_t badPartitionsLeft, bool isLeftmost)
+		{
+			while (true)
+			{
+				const auto size = end - begin;
+				if (size < InsertionSortThreshold)
+				{
+					InsertionSort(begin, end, less);
+					return;
+				}
+
+				const auto half = size / 2;
+				if (size > NintherThreshold)
+				{
+					Sort3(begin, begin + half, end - 1, less);
+					Sort3(begin + 1, begin + (half - 1), end - 2, less);
+					Sort3(begin + 2, begin + (half + 1), end - 3, less);
+					Sort3(begin + (half - 1), begin + half, begin + (half + 1), less);
+					std::iter_swap(begin, begin + half);
+				}
+				else
+					Sort3(begin + half, begin, end - 1, less);
+
+				// The pivot equals the element before the range, so everything equal to it belongs right there
+				if (!isLeftmost && !less(*(begin - 1), *begin))
+				{
+					begin = PartitionLeft(begin, end, less) + 1;
+					continue;
+				}
+
+				const auto [pivot, isPartitioned] = PartitionRight(begin, end, less);
+
+				const auto leftSize = pivot - begin;
+				const auto rightSize = end - (pivot + 1);
+
+				if (leftSize < size / 8 || rightSize < size / 8)
+				{
+					if (--badPartitionsLeft == 0)
+					{
+						std::make_heap(begin, end, less);
+						std::sort_heap(begin, end, less);
+						return;
+					}
+
+					// Break patterns that lead to unbalanced partitions
+					if (leftSize >= InsertionSortThreshold)
+					{
+						std::iter_swap(begin, begin + leftSize / 4);
+						std::iter_swap(pivot - 1, pivot - leftSize / 4);
+
+						if (leftSize > NintherThreshold)
+						{
+							std::iter_swap(begin + 1, begin + (leftSize / 4 + 1));
+							std::iter_swap(begin + 2, begin + (leftSize / 4 + 2));
+							std::iter_swap(pivot - 2, pivot - (leftSize / 4 + 1));
+							std::iter_swap(pivot - 3, pivot - (leftSize / 4 + 2));
+						}
+					}
+
+					if (rightSize >= InsertionSortThreshold)
+					{
+						std::iter_swap(pivot + 1, pivot + (1 + rightSize / 4));
+						std::iter_swap(end - 1, end - rightSize / 4);
+
+						if (rightSize > NintherThreshold)
+						{
+							std::iter_swap(pivot + 2, pivot + (2 + rightSize / 4));
+							std::iter_swap(pivot + 3, pivot + (3 + rightSize / 4));
+							std::iter_swap(end - 2, end - (1 + rightSize / 4));
+							std::iter_swap(end - 3, end - (2 + rightSize / 4));
+						}
+					}
+				}
+				else if (isPartitioned && PartialInsertionSort(begin, pivot, less) && PartialInsertionSort(pivot + 1, end, less))
+					return;
+
+				PdqSortLoop(begin, pivot, less, badPartitionsLeft, isLeftmost);
+
+				begin = pivot + 1;
+				isLeftmost = false;
+			}
+		}
+	}
+
+	// Pattern-defeating quicksort: quicksort with median-of-3 (ninther for large ranges) pivots that switches to insertion sort
+	// for runs which look already sorted, puts runs of equal elements in place in a single pass and falls back to heapsort after
+	// too many unbalanced partitions, so it is O(n log n) in the worst case. It is not stable.
+	// Every scan is bounds-checked: a comparator which is not a strict weak ordering gives an unspecified order, never a crash.
+	template <typename Iterator, typename Less>
+	void PdqSort(Iterator begin, Iterator end, Less less)
+	{
+		size_t log = 0;
+		for (auto size = end - begin; size > 1; size >>= 1) ++log;
+
+		if (log != 0)
+			details::PdqSortLoop(begin, end, less, log, true);
+	}
+
+	// LSD radix sort of signed integers, one byte per pass. Values are sorted as offsets from the minimum, so only the bytes
+	// spanned by the value range are visited, and passes where every value has the same byte are skipped.
+	template <typename T>
+	void RadixSort(T* values, size_t size)
+	{
+		static_assert(std::is_integral_v<T> && std::is_signed_v<T>);
+
+		using Key = std::make_unsigned_t<T>;
+
+		constexpr size_t BucketCount = 256;
+
+		if (size < 2 || std::is_sorted(values, values + size))
+			return;
+
+		const auto [minimum, maximum] = std::minmax_element(values, values + size);
+		const auto base = static_cast<Key>(*minimum);
+
+		size_t digitCount = 0;
+		for (auto range = static_cast<Key>(static_cast<Key>(*maximum) - base); range != 0; range >>= 8) ++digitCount;
+
+		const auto getDigit = [base](T value, size_t digit)
+		{ return static_cast<size_t>(static_cast<Key>(static_cast<Key>(value) - base) >> (digit * 8)) & 0xFF; };
+
+		std::vector<size_t> counts(digitCount * BucketCount);
+		for (size_t i = 0; i < size; ++i)
+			for (size_t digit = 0; digit < digitCount; ++digit) ++counts[digit * BucketCount + getDigit(values[i], digit)];
+
+		const std::unique_ptr<T[]> buffer(new T[size]);
+
+		auto source = values;
+		auto target = buffer.get();
+
+		for (size_t digit = 0; digit < digitCount; ++digit)
+		{
+			const auto offsets = &counts[digit * BucketCount];
+			if (offsets[getDigit(source[0], digit)] == size)
+				continue;
+
+			size_t offset = 0;
+			for (size_t bucket = 0; bucket < BucketCount; ++bucket) offset += std::exchange(offsets[bucket], offset);
+
+			for (size_t i = 0; i < size; ++i) target[offsets[getDigit(source[i], digit)]++] = source[i];
+
+			std::swap(source, target);
+		}
+
+		if (source != values)
+			std::memcpy(values, source, size * sizeof(T));
+	}
+}
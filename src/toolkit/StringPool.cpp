@@ -2,10 +2,22 @@
 
 #include <toolkit/Macro.hpp>
 
+#include <mutex>
+
 namespace pet
 {
 	StringPoolId StringPool::Add(std::string&& str)
 	{
+		{
+			const std::shared_lock lock(_mutex);
+
+			const auto it = _stringToIds.find(str);
+			if (it != _stringToIds.end())
+				return it->second;
+		}
+
+		const std::unique_lock lock(_mutex);
+
 		const auto it = _stringToIds.find(str);
 		if (it != _stringToIds.end())
 			return it->second;
@@ -18,6 +30,8 @@ namespace pet
 
 	std::string_view StringPool::Get(StringPoolId id) const
 	{
+		const std::shared_lock lock(_mutex);
+
 		PET_CHECK(id < _strings.size(), ArgumentException("id"));
 		return _strings[id];
 	}
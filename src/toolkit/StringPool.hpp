@@ -1,6 +1,7 @@
 #pragma once
 
 #include <deque>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 
@@ -8,9 +9,11 @@ namespace pet
 {
 	using StringPoolId = size_t;
 
+	// Thread-safe, and the views returned by Get stay valid as long as the pool
 	class StringPool
 	{
 	private:
+		mutable std::shared_mutex					  _mutex;
 		std::unordered_map<std::string, StringPoolId> _stringToIds;
 		std::deque<std::string>						  _strings;
 
@@ -1,16 +1,41 @@
 #include <toolkit/StringUtils.hpp>
 
-#include <sstream>
+#include <cstring>
 
 namespace pet
 {
-	std::vector<std::string> StringUtils::Split(std::string_view str, char separator)
+	size_t StringUtils::Find(std::string_view str, std::string_view substring, size_t offset)
 	{
-		std::vector<std::string> result;
+		if (offset > str.size() || substring.size() > str.size() - offset)
+			return std::string_view::npos;
 
-		std::stringstream sstream{std::string(str)};
-		std::string		  token;
-		while (std::getline(sstream, token, separator)) result.push_back(std::move(token));
+		if (substring.empty())
+			return offset;
+
+		const auto begin = str.data() + offset;
+		const auto size = str.size() - offset;
+
+		const auto match = substring.size() == 1 ? std::memchr(begin, substring[0], size)
+												 : memmem(begin, size, substring.data(), substring.size());
+
+		return match ? static_cast<size_t>(static_cast<const char*>(match) - str.data()) : std::string_view::npos;
+	}
+
+	std::vector<std::string_view> StringUtils::Split(std::string_view str, std::string_view separator)
+	{
+		if (separator.empty())
+			return {str};
+
+		std::vector<std::string_view> result;
+
+		size_t begin = 0;
+		for (auto end = Find(str, separator); end != std::string_view::npos; end = Find(str, separator, begin))
+		{
+			result.push_back(str.substr(begin, end - begin));
+			begin = end + separator.size();
+		}
+
+		result.push_back(str.substr(begin));
 
 		return result;
 	}
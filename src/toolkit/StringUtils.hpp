@@ -1,13 +1,19 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace pet
 {
 	struct StringUtils
 	{
-		static std::vector<std::string> Split(std::string_view str, char separator = ' ');
+		// Returns the position of the first occurrence of substring at or after offset, or std::string_view::npos.
+		// Single characters are searched with memchr and longer substrings with memmem (two-way search).
+		static size_t Find(std::string_view str, std::string_view substring, size_t offset = 0);
+
+		// Returns views into str, so they are only valid as long as str is. An empty separator does not split.
+		static std::vector<std::string_view> Split(std::string_view str, std::string_view separator = " ");
 
 		template <typename... Args>
 		static std::string Concat(Args&&... args)
@@ -0,0 +1,215 @@
+#include <toolkit/ThreadPool.hpp>
+
+#include <toolkit/ScopedInvoker.hpp>
+
+#include <algorithm>
+#include <exception>
+
+namespace pet
+{
+	namespace
+	{
+		thread_local const ThreadPool* CurrentPool = nullptr;
+		thread_local size_t			   CurrentQueue = 0;
+	}
+
+	ThreadPool::ThreadPool(size_t threadCount)
+		: _threadCount(threadCount), _startTime(std::chrono::steady_clock::now()), _callerTaskCount(0), _taskCount(0), _nextQueue(0),
+		  _isStopping(false)
+	{
+		for (size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i) _queues.emplace_back(std::make_unique<Queue>());
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		while (TryRunTask())
+			continue;
+
+		{
+			const std::lock_guard lock(_mutex);
+			_isStopping = true;
+		}
+
+		_condition.notify_all();
+
+		for (auto& thread : _threads) thread.join();
+	}
+
+	void ThreadPool::Submit(Task&& task)
+	{
+		std::call_once(_startFlag, [this]() { Start(); });
+
+		// Tasks submitted by a worker stay on its own deque, the others are spread over all workers
+		const auto index = CurrentPool == this ? CurrentQueue : _nextQueue++ % _queues.size();
+
+		{
+			const std::lock_guard lock(_mutex);
+			++_taskCount;
+		}
+
+		{
+			auto&				  queue = *_queues[index];
+			const std::lock_guard lock(queue.Mutex);
+			queue.Tasks.push_back(std::move(task));
+		}
+
+		_condition.notify_one();
+	}
+
+	void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& body)
+	{
+		if (_threadCount == 0 || count == 1)
+		{
+			for (size_t i = 0; i < count; ++i) body(i);
+			return;
+		}
+
+		std::atomic<size_t> remaining(count);
+		std::mutex			exceptionMutex;
+		std::exception_ptr	exception;
+
+		for (size_t i = 0; i < count; ++i)
+			Submit(
+				[&, i]()
+				{
+					try
+					{
+						body(i);
+					}
+					catch (...)
+					{
+						const std::lock_guard lock(exceptionMutex);
+						if (!exception)
+							exception = std::current_exception();
+					}
+
+					--remaining;
+				});
+
+		while (remaining > 0)
+			if (!TryRunTask())
+				std::this_thread::yield();
+
+		if (exception)
+			std::rethrow_exception(exception);
+	}
+
+	size_t ThreadPool::GetDefaultThreadCount()
+	{
+		// The thread waiting for the results runs tasks as well
+		return std::max<size_t>(std::thread::hardware_concurrency(), 1) - 1;
+	}
+
+	ThreadPool::Stats ThreadPool::GetStats() const
+	{
+		const auto elapsedTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _startTime);
+
+		Stats stats;
+		stats.CallerTaskCount = _callerTaskCount.load(std::memory_order_relaxed);
+
+		for (size_t i = 0; i < _queues.size(); ++i)
+		{
+			auto& queue = *_queues[i];
+
+			WorkerStats worker;
+			{
+				const std::lock_guard lock(queue.Mutex);
+				worker.QueueDepth = queue.Tasks.size();
+			}
+
+			worker.TaskCount = queue.TaskCount.load(std::memory_order_relaxed);
+			worker.StealCount = queue.StealCount.load(std::memory_order_relaxed);
+			worker.Utilization = i < _threads.size() && elapsedTime.count() > 0
+									 ? static_cast<double>(queue.BusyTime.load(std::memory_order_relaxed)) /
+										   static_cast<double>(elapsedTime.count())
+									 : 0.0;
+
+			stats.Workers.push_back(worker);
+		}
+
+		return stats;
+	}
+
+	void ThreadPool::Start()
+	{
+		_threads.reserve(_threadCount);
+		for (size_t i = 0; i < _threadCount; ++i) _threads.emplace_back([this, i]() { Run(i); });
+	}
+
+	void ThreadPool::Run(size_t index)
+	{
+		CurrentPool = this;
+		CurrentQueue = index;
+
+		while (true)
+		{
+			if (TryRunTask())
+				continue;
+
+			std::unique_lock lock(_mutex);
+			_condition.wait(lock, [this]() { return _isStopping || _taskCount > 0; });
+
+			if (_isStopping && _taskCount == 0)
+				return;
+		}
+	}
+
+	bool ThreadPool::TryRunTask()
+	{
+		const auto isWorker = CurrentPool == this;
+		const auto first = isWorker ? CurrentQueue : 0;
+
+		for (size_t i = 0; i < _queues.size(); ++i)
+		{
+			auto& queue = *_queues[(first + i) % _queues.size()];
+			Task  task;
+
+			{
+				const std::lock_guard lock(queue.Mutex);
+				if (queue.Tasks.empty())
+					continue;
+
+				if (isWorker && i == 0)
+				{
+					task = std::move(queue.Tasks.back());
+					queue.Tasks.pop_back();
+				}
+				else
+				{
+					task = std::move(queue.Tasks.front());
+					queue.Tasks.pop_front();
+				}
+			}
+
+			--_taskCount;
+
+			if (!isWorker)
+			{
+				_callerTaskCount.fetch_add(1, std::memory_order_relaxed);
+				task();
+
+				return true;
+			}
+
+			auto&	   worker = *_queues[CurrentQueue];
+			const auto start = std::chrono::steady_clock::now();
+
+			const ScopedInvoker addBusyTime(
+				[&]()
+				{
+					const auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+					worker.BusyTime.fetch_add(static_cast<uint64_t>(time.count()), std::memory_order_relaxed);
+				});
+
+			worker.TaskCount.fetch_add(1, std::memory_order_relaxed);
+			if (i != 0)
+				worker.StealCount.fetch_add(1, std::memory_order_relaxed);
+
+			task();
+
+			return true;
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <toolkit/Macro.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pet
+{
+	// Work-stealing pool: every worker owns a deque, runs its newest task first and steals the oldest task of another worker
+	// when its own deque is empty. Threads are only started by the first submitted task: once a process has more than one
+	// thread, every shared_ptr copy pays for an atomic operation, so scripts that never go parallel should not start any.
+	class ThreadPool
+	{
+		PET_NON_COPYABLE(ThreadPool);
+
+		using Task = std::function<void()>;
+
+		// Counters are only written by the worker owning the queue
+		struct Queue
+		{
+			std::mutex		 Mutex;
+			std::deque<Task> Tasks;
+
+			std::atomic<uint64_t> TaskCount{0};
+			std::atomic<uint64_t> StealCount{0};
+			std::atomic<uint64_t> BusyTime{0};
+		};
+
+	public:
+		struct WorkerStats
+		{
+			size_t	 QueueDepth;
+			uint64_t TaskCount;
+			uint64_t StealCount;
+
+			// Share of the time since the pool was created spent running tasks, from 0 to 1
+			double Utilization;
+		};
+
+		struct Stats
+		{
+			// One per queue: every worker thread owns one, and a pool without threads keeps a single one
+			std::vector<WorkerStats> Workers;
+
+			// Tasks run by threads waiting for results, which are not workers
+			uint64_t CallerTaskCount;
+		};
+
+	private:
+		const size_t _threadCount;
+
+		std::vector<std::unique_ptr<Queue>> _queues;
+		std::vector<std::thread>			_threads;
+		std::once_flag						_startFlag;
+
+		const std::chrono::steady_clock::time_point _startTime;
+		std::atomic<uint64_t>						_callerTaskCount;
+
+		std::mutex				_mutex;
+		std::condition_variable _condition;
+		std::atomic<size_t>		_taskCount;
+		std::atomic<size_t>		_nextQueue;
+		bool					_isStopping;
+
+	public:
+		explicit ThreadPool(size_t threadCount = GetDefaultThreadCount());
+
+		// Runs the tasks still queued, with the help of the destroying thread, then joins the threads
+		~ThreadPool();
+
+		size_t GetThreadCount() const
+		{
+			return _threadCount;
+		}
+
+		void Submit(Task&& task);
+
+		// Runs body(0), ..., body(count - 1) on the pool and waits for all of them. The calling thread runs queued tasks while
+		// it waits, so a task may call ParallelFor itself. The first exception thrown by body is rethrown to the caller.
+		// Without worker threads the bodies simply run in order on the calling thread.
+		void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
+		// Runs one queued task on the calling thread, if there is any, so that threads waiting for tasks can help with them
+		bool TryRunTask();
+
+		// A snapshot of counters updated as tasks run, so they need not be consistent with each other
+		Stats GetStats() const;
+
+		static size_t GetDefaultThreadCount();
+
+	private:
+		void Start();
+		void Run(size_t index);
+	};
+}
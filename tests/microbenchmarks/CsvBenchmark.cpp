@@ -0,0 +1,58 @@
+#include <pet/runtime/Csv.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+using namespace pet;
+
+namespace
+{
+	template <typename F>
+	double Measure(F&& func)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void Run(std::string_view name, const String& text, bool asColumns)
+	{
+		auto&	   interner = StringInterner::GetInstance();
+		ThreadPool threadPool;
+
+		CsvOptions options;
+		options.AsColumns = asColumns;
+
+		ValuePtr   value;
+		const auto time = Measure([&]() { value = Csv::Read(text, options, interner, threadPool); });
+
+		std::cout << name << " (" << threadPool.GetThreadCount() + 1 << " threads): " << time << " ms, "
+				  << static_cast<double>(text.GetLength()) / (1024 * 1024) / (time / 1000) << " MB/s" << std::endl;
+	}
+}
+
+int main()
+{
+	constexpr size_t Size = 200 * 1024 * 1024;
+
+	std::mt19937_64 random(42);
+
+	std::string text = "id,quantity,price,city,comment\n";
+	for (size_t i = 0; text.size() < Size; ++i)
+	{
+		text += std::to_string(i) + ',' + std::to_string(random() % 1000);
+		text += ',' + std::to_string(static_cast<double>(random() % 100000) / 100);
+		text += ",city" + std::to_string(random() % 500);
+		text += random() % 10 == 0 ? ",\"quoted, with \"\"escapes\"\"\"\n" : ",plain comment\n";
+	}
+
+	const String input(text);
+
+	Run("Columns", input, true);
+	Run("Rows   ", input, false);
+
+	return EXIT_SUCCESS;
+}
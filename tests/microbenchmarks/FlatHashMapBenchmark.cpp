@@ -0,0 +1,158 @@
+#include <pet/runtime/Value.hpp>
+
+#include <toolkit/FlatHashMap.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+
+using namespace pet;
+
+namespace
+{
+	using UnorderedMapType = std::unordered_map<String, ValuePtr, StringHasher>;
+	using FlatHashMapType = FlatHashMap<String, ValuePtr, StringHasher, StringEqual>;
+
+	template <typename F>
+	double Measure(F&& func)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	std::vector<String> MakeKeys(size_t count, std::string_view prefix)
+	{
+		std::vector<String> result;
+		result.reserve(count);
+
+		for (size_t i = 0; i < count; ++i) result.emplace_back(std::string(prefix) + std::to_string(i));
+
+		return result;
+	}
+
+	void Insert(UnorderedMapType& map, const String& key, const ValuePtr& value)
+	{
+		map.insert_or_assign(key, value);
+	}
+
+	void Insert(FlatHashMapType& map, const String& key, const ValuePtr& value)
+	{
+		map.InsertOrAssign(key, value);
+	}
+
+	bool Contains(const UnorderedMapType& map, const String& key)
+	{
+		return map.find(key) != map.end();
+	}
+
+	bool Contains(const FlatHashMapType& map, const String& key)
+	{
+		return map.Find(key) != nullptr;
+	}
+
+	void Erase(UnorderedMapType& map, const String& key)
+	{
+		map.erase(key);
+	}
+
+	void Erase(FlatHashMapType& map, const String& key)
+	{
+		map.Erase(key);
+	}
+
+	// Keys are copied before every lookup so that each one pays for hashing, as freshly computed dictionary keys do
+	template <typename MapType>
+	void Run(std::string_view name, const std::vector<String>& keys, const std::vector<String>& missingKeys)
+	{
+		MapType	   map;
+		size_t	   found = 0;
+		const auto value = std::make_shared<Value>(ValueIntegerType(42));
+
+		const auto insert = Measure(
+			[&]()
+			{
+				for (const auto& key : keys) Insert(map, key, value);
+			});
+
+		const auto hit = Measure(
+			[&]()
+			{
+				for (const auto& key : keys) found += Contains(map, String(key.GetView()));
+			});
+
+		const auto miss = Measure(
+			[&]()
+			{
+				for (const auto& key : missingKeys) found += Contains(map, String(key.GetView()));
+			});
+
+		const auto iterate = Measure(
+			[&]()
+			{
+				for (const auto& entry : map) found += entry.second ? 1 : 0;
+			});
+
+		const auto churn = Measure(
+			[&]()
+			{
+				for (size_t i = 0; i < keys.size(); i += 2) Erase(map, keys[i]);
+				for (size_t i = 0; i < keys.size(); i += 2) Insert(map, keys[i], value);
+			});
+
+		std::cout << name << ": insert " << insert << " ms, hit " << hit << " ms, miss " << miss << " ms, iterate " << iterate
+				  << " ms, erase/reinsert " << churn << " ms (" << found << ")" << std::endl;
+	}
+
+	// One key erased and inserted again many times in a small map, then iterated: tombstones must not pile up
+	template <typename MapType>
+	void RunChurn(std::string_view name, const std::vector<String>& keys, size_t iterations)
+	{
+		MapType	   map;
+		size_t	   found = 0;
+		const auto value = std::make_shared<Value>(ValueIntegerType(42));
+
+		for (const auto& key : keys) Insert(map, key, value);
+
+		const auto churn = Measure(
+			[&]()
+			{
+				for (size_t i = 0; i < iterations; ++i)
+				{
+					Erase(map, keys[0]);
+					Insert(map, keys[0], value);
+				}
+			});
+
+		const auto iterate = Measure(
+			[&]()
+			{
+				for (const auto& entry : map) found += entry.second ? 1 : 0;
+			});
+
+		std::cout << name << ": erase/insert " << churn << " ms, iterate " << iterate << " ms (" << found << ")" << std::endl;
+	}
+}
+
+int main()
+{
+	for (const size_t count : {1000, 200000, 1000000})
+	{
+		const auto keys = MakeKeys(count, "k");
+		const auto missingKeys = MakeKeys(count, "m");
+
+		std::cout << "Keys: " << count << std::endl;
+		Run<UnorderedMapType>("  std::unordered_map", keys, missingKeys);
+		Run<FlatHashMapType>("  FlatHashMap       ", keys, missingKeys);
+	}
+
+	constexpr size_t ChurnIterations = 10000000;
+
+	const auto churnKeys = MakeKeys(8, "k");
+
+	std::cout << "Churn: " << ChurnIterations << std::endl;
+	RunChurn<UnorderedMapType>("  std::unordered_map", churnKeys, ChurnIterations);
+	RunChurn<FlatHashMapType>("  FlatHashMap       ", churnKeys, ChurnIterations);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#include <pet/runtime/Json.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+using namespace pet;
+
+namespace
+{
+	template <typename F>
+	double Measure(F&& func)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void Report(std::string_view name, size_t size, double time)
+	{
+		std::cout << name << ": " << time << " ms, " << static_cast<double>(size) / (1024 * 1024) / (time / 1000) << " MB/s" << std::endl;
+	}
+
+	void Run(std::string_view name, const std::string& text)
+	{
+		std::cout << name << " (" << text.size() / (1024 * 1024) << " MB)" << std::endl;
+
+		auto&		 interner = StringInterner::GetInstance();
+		const String input(text);
+
+		ValuePtr   value;
+		const auto parseTime = Measure([&]() { value = Json::Parse(input, interner); });
+		Report("  Parse    ", text.size(), parseTime);
+
+		std::string output;
+		const auto	writeTime = Measure([&]() { Json::Write(output, *value); });
+		Report("  Stringify", output.size(), writeTime);
+	}
+}
+
+int main()
+{
+	constexpr size_t Size = 100 * 1024 * 1024;
+
+	std::mt19937_64 random(42);
+
+	// Small records with the same keys, as in most API payloads and logs
+	std::string records = "[";
+	for (size_t i = 0; records.size() < Size; ++i)
+	{
+		records += i == 0 ? "{" : ",{";
+		records += "\"id\":" + std::to_string(i);
+		records += ",\"name\":\"user " + std::to_string(random() % 100000) + "\"";
+		records += ",\"score\":" + std::to_string(static_cast<double>(random() % 100000) / 7);
+		records += ",\"active\":" + std::string(random() % 2 ? "true" : "false");
+		records += ",\"tags\":[\"alpha\",\"beta\",\"gamma\"]";
+		records += ",\"note\":\"line\\nwith \\\"escapes\\\"\"}";
+	}
+	records += "]";
+
+	// Large arrays of numbers
+	std::string numbers = "[";
+	for (size_t i = 0; numbers.size() < Size; ++i)
+	{
+		numbers += i == 0 ? "[" : ",[";
+		for (size_t j = 0; j < 1000; ++j)
+		{
+			if (j != 0)
+				numbers += ',';
+			numbers += std::to_string(static_cast<int64_t>(random() % 2000000) - 1000000);
+		}
+		numbers += "]";
+	}
+	numbers += "]";
+
+	Run("Records", records);
+	Run("Numbers", numbers);
+
+	return EXIT_SUCCESS;
+}
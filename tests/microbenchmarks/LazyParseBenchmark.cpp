@@ -0,0 +1,85 @@
+#include <pet/Context.hpp>
+#include <pet/Script.hpp>
+#include <pet/parser/Parser.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace pet;
+
+namespace
+{
+	template <typename F>
+	double Measure(F&& func)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// A library of helpers of about ten lines each, of which the script only calls a few
+	std::string MakeLibrary(size_t functionCount, size_t calledCount)
+	{
+		std::ostringstream library;
+
+		for (size_t i = 0; i < functionCount; ++i)
+		{
+			library << "fun helper" << i << "(record) {\n"
+					<< "\tvar score = record.score * " << i % 13 + 1 << " + (" << i << " - 3) * 2;\n"
+					<< "\tif (record.kind == \"kind" << i % 7 << "\" and score > " << i % 100 << ") {\n"
+					<< "\t\treturn score + len(record.tags);\n"
+					<< "\t}\n"
+					<< "\twhile (score > 1000) {\n"
+					<< "\t\tscore = score / 2;\n"
+					<< "\t}\n"
+					<< "\treturn -score;\n"
+					<< "}\n";
+		}
+
+		library << "var record = {};\nrecord.score = 7;\nrecord.kind = \"kind3\";\nrecord.tags = [1, 2];\n";
+		for (size_t i = 0; i < calledCount; ++i) library << "helper" << i * (functionCount / calledCount) << "(record);\n";
+
+		return library.str();
+	}
+
+	double MeasureParse(const std::string& source, bool isLazy)
+	{
+		Context context;
+
+		return Measure(
+			[&]()
+			{
+				std::istringstream stream(source);
+				Parser			   parser(context, stream, isLazy);
+
+				while (!parser.IsEndOfStream()) parser.GetStatement();
+			});
+	}
+}
+
+int main()
+{
+	constexpr size_t FunctionCount = 2000;
+	constexpr size_t CalledCount = 20;
+
+	const auto source = MakeLibrary(FunctionCount, CalledCount);
+
+	const auto eagerTime = MeasureParse(source, false);
+	const auto lazyTime = MeasureParse(source, true);
+	const auto runTime = Measure(
+		[&]()
+		{
+			std::istringstream stream(source);
+			Script().Run(stream);
+		});
+
+	std::cout << "Library of " << source.size() / 1024 << " KB (" << FunctionCount << " functions, " << CalledCount << " called)"
+			  << std::endl;
+	std::cout << "  Eager parse        : " << eagerTime << " ms" << std::endl;
+	std::cout << "  Lazy parse         : " << lazyTime << " ms" << std::endl;
+	std::cout << "  Lazy parse and run : " << runTime << " ms" << std::endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+#include <pet/ExecutionContext.hpp>
+#include <pet/Program.hpp>
+#include <pet/Script.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pet;
+
+namespace
+{
+	template <typename F>
+	double Measure(F&& func)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// Calls, member accesses, string literals and nulls, all of them shared by the threads running the program
+	const std::string Source = R"(
+		fun score(record) {
+			if (record.kind == "premium") return record.amount * 2;
+			return record.amount;
+		}
+
+		fun run(count) {
+			var record = {};
+			record.kind = "premium";
+			record.amount = 0;
+
+			var total = 0;
+			var i = 0;
+			while (i < count) {
+				record.amount = i % 100;
+				total = total + score(record);
+				if (record.missing == null) i = i + 1;
+			}
+			return total;
+		}
+
+		assert(run(200000) == 19800000);
+	)";
+
+	double RunOnThreads(Script& script, const ProgramConstPtr& program, size_t threadCount)
+	{
+		std::vector<std::unique_ptr<ExecutionContext>> executions;
+		for (size_t i = 0; i < threadCount; ++i) executions.push_back(script.CreateExecutionContext());
+
+		return Measure(
+			[&]()
+			{
+				std::vector<std::thread> threads;
+				for (auto& execution : executions) threads.emplace_back([&]() { execution->Run(*program); });
+				for (auto& thread : threads) thread.join();
+			});
+	}
+}
+
+int main()
+{
+	const auto maxThreadCount = std::max<size_t>(std::thread::hardware_concurrency(), 4);
+
+	Script script;
+
+	std::istringstream stream(Source);
+	const auto		   program = script.Compile(stream);
+
+	// Timed on a thread of its own like the execution contexts. Once a process has started a thread, reference counts and malloc
+	// use atomic operations, which makes the interpreter about twice as slow as in a process which never did.
+	const auto mainTime = Measure(
+		[]()
+		{
+			std::thread thread(
+				[]()
+				{
+					std::istringstream mainStream(Source);
+					Script().Run(mainStream);
+				});
+			thread.join();
+		});
+	const auto singleTime = RunOnThreads(script, program, 1);
+
+	std::cout << "One program run by N threads at once (" << std::thread::hardware_concurrency() << " cores)" << std::endl;
+	std::cout << "  Main interpreter : " << mainTime << " ms" << std::endl;
+	for (size_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2)
+	{
+		const auto time = RunOnThreads(script, program, threadCount);
+		std::cout << "  " << threadCount << " threads : " << time << " ms, " << singleTime * static_cast<double>(threadCount) / time
+				  << "x throughput" << std::endl;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#include <pet/Script.hpp>
+#include <pet/ScriptCache.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace pet;
+
+namespace
+{
+	template <typename F>
+	double Measure(F&& func)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// A rules file of about ten lines per rule, which the script declares and then applies once each to a record, so that every
+	// body is parsed or loaded
+	void WriteRules(const std::string& path, size_t ruleCount)
+	{
+		std::ofstream rules(path);
+
+		for (size_t i = 0; i < ruleCount; ++i)
+		{
+			rules << "fun rule" << i << "(record) {\n"
+				  << "\tvar score = record.score * " << i % 13 + 1 << " + (" << i << " - 3) * 2;\n"
+				  << "\tif (record.kind == \"kind" << i % 7 << "\" and score > " << i % 100 << ") {\n"
+				  << "\t\treturn score + len(record.tags);\n"
+				  << "\t}\n"
+				  << "\twhile (score > 1000) {\n"
+				  << "\t\tscore = score / 2;\n"
+				  << "\t}\n"
+				  << "\treturn -score;\n"
+				  << "}\n";
+		}
+
+		rules << "const record = { };\n"
+			  << "record.score = 42;\n"
+			  << "record.kind = \"kind3\";\n"
+			  << "record.tags = [\"a\", \"b\"];\n"
+			  << "var total = 0;\n";
+
+		for (size_t i = 0; i < ruleCount; ++i) rules << "total = total + rule" << i << "(record);\n";
+	}
+}
+
+int main()
+{
+	constexpr size_t RuleCount = 1000;
+
+	const auto directory = std::filesystem::temp_directory_path() / "pet-script-cache-benchmark";
+	const auto path = (directory / "rules.pet").string();
+
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+	WriteRules(path, RuleCount);
+
+	const ScriptCache cache((directory / "cache").string());
+
+	const auto parseTime = Measure(
+		[&]()
+		{
+			std::ifstream stream(path);
+			Script().Run(stream);
+		});
+	const auto missTime = Measure([&]() { Script().RunFile(path, cache); });
+	const auto hitTime = Measure([&]() { Script().RunFile(path, cache); });
+
+	std::cout << "Rules of " << std::filesystem::file_size(path) / 1024 << " KB (" << RuleCount * 10 << " lines)" << std::endl;
+	std::cout << "  Parse and run      : " << parseTime << " ms" << std::endl;
+	std::cout << "  Cache miss and run : " << missTime << " ms" << std::endl;
+	std::cout << "  Cache hit and run  : " << hitTime << " ms" << std::endl;
+
+	std::filesystem::remove_all(directory);
+
+	return EXIT_SUCCESS;
+}
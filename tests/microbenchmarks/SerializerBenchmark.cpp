@@ -0,0 +1,82 @@
+#include <pet/runtime/Array.hpp>
+#include <pet/runtime/Dictionary.hpp>
+#include <pet/runtime/Serializer.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+using namespace pet;
+
+namespace
+{
+	template <typename F>
+	double Measure(F&& func)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void Report(std::string_view name, size_t size, double time)
+	{
+		std::cout << name << ": " << time << " ms, " << static_cast<double>(size) / (1024 * 1024) / (time / 1000) << " MB/s" << std::endl;
+	}
+
+	void Run(std::string_view name, const ValuePtr& value)
+	{
+		auto& interner = StringInterner::GetInstance();
+
+		std::string bytes;
+		const auto	serializeTime = Measure([&]() { Serializer::Serialize(bytes, *value); });
+
+		std::cout << name << " (" << bytes.size() / (1024 * 1024) << " MB)" << std::endl;
+		Report("  Serialize  ", bytes.size(), serializeTime);
+
+		const String input(bytes);
+		ValuePtr	 result;
+		const auto	 deserializeTime = Measure([&]() { result = Serializer::Deserialize(input, interner); });
+		Report("  Deserialize", bytes.size(), deserializeTime);
+	}
+}
+
+int main()
+{
+	constexpr size_t RecordCount = 2000000;
+	constexpr size_t NumberCount = 50000000;
+
+	std::mt19937_64 random(42);
+	auto&			interner = StringInterner::GetInstance();
+
+	const auto idKey = std::make_shared<Value>(interner.Intern("id"));
+	const auto nameKey = std::make_shared<Value>(interner.Intern("name"));
+	const auto scoresKey = std::make_shared<Value>(interner.Intern("scores"));
+	const auto parentKey = std::make_shared<Value>(interner.Intern("parent"));
+
+	// Records pointing at one another, as in a typical state graph
+	std::vector<ValuePtr> records;
+	records.reserve(RecordCount);
+
+	for (size_t i = 0; i < RecordCount; ++i)
+	{
+		auto record = std::make_shared<Dictionary>();
+		record->Set(idKey, std::make_shared<Value>(static_cast<ValueIntegerType>(i)));
+		record->Set(nameKey, std::make_shared<Value>(String("record " + std::to_string(random() % 100000))));
+		record->Set(scoresKey, std::make_shared<Value>(std::make_shared<Array>(std::vector<ValueFloatType>{0.5, 1.5, 2.5})));
+
+		if (i != 0)
+			record->Set(parentKey, records[random() % i]);
+
+		records.push_back(std::make_shared<Value>(std::move(record)));
+	}
+
+	std::vector<ValueIntegerType> numbers(NumberCount);
+	for (auto& number : numbers) number = static_cast<ValueIntegerType>(random() % 100000);
+
+	Run("Records", std::make_shared<Value>(std::make_shared<Array>(std::move(records))));
+	Run("Integers", std::make_shared<Value>(std::make_shared<Array>(std::move(numbers))));
+
+	return EXIT_SUCCESS;
+}
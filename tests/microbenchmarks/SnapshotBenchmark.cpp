@@ -0,0 +1,88 @@
+#include <pet/Script.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace pet;
+
+namespace
+{
+	template <typename F>
+	double Measure(F&& func)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// A prelude in the style of a rules library: many small functions and a few tables computed at startup
+	std::string MakePrelude(size_t functionCount, size_t tableSize)
+	{
+		std::ostringstream prelude;
+
+		for (size_t i = 0; i < functionCount; ++i)
+		{
+			prelude << "fun rule" << i << "(record) {\n"
+					<< "\tif (record.score > " << i % 100 << " and record.kind == \"kind" << i % 7 << "\") {\n"
+					<< "\t\treturn record.score * " << i << " + len(record.tags);\n"
+					<< "\t}\n"
+					<< "\treturn -1;\n"
+					<< "}\n";
+		}
+
+		prelude << "var squares = [];\n"
+				<< "var i = 0;\n"
+				<< "while (i < " << tableSize << ") { push(squares, i * i); i = i + 1; }\n"
+				<< "var names = {};\n"
+				<< "i = 0;\n"
+				<< "while (i < " << tableSize / 10 << ") {\n"
+				<< "\tvar entry = {};\n"
+				<< "\tentry.id = i;\n"
+				<< "\tentry.label = \"label\" + str(i);\n"
+				<< "\tnames[\"name\" + str(i)] = entry;\n"
+				<< "\ti = i + 1;\n"
+				<< "}\n";
+
+		return prelude.str();
+	}
+}
+
+int main()
+{
+	constexpr size_t FunctionCount = 5000;
+	constexpr size_t TableSize = 500000;
+
+	const auto prelude = MakePrelude(FunctionCount, TableSize);
+	const auto path = (std::filesystem::temp_directory_path() / "pet-snapshot-benchmark.img").string();
+
+	Script warmScript;
+
+	std::istringstream preludeStream(prelude);
+	const auto		   runTime = Measure([&]() { warmScript.Run(preludeStream); });
+	const auto		   saveTime = Measure([&]() { warmScript.SaveSnapshot(path); });
+
+	Script	   coldScript;
+	const auto loadTime = Measure([&]() { coldScript.LoadSnapshot(path); });
+
+	std::istringstream check("var record = {};\n"
+							 "record.score = 50;\n"
+							 "record.kind = \"kind3\";\n"
+							 "record.tags = [1, 2];\n"
+							 "assert(rule10(record) == 502);\n"
+							 "assert(squares[1000] == 1000000 and names.name42.label == \"label42\");\n");
+	coldScript.Run(check);
+
+	std::cout << "Prelude of " << prelude.size() / 1024 << " KB, snapshot of " << std::filesystem::file_size(path) / 1024 << " KB"
+			  << std::endl;
+	std::cout << "  Run prelude  : " << runTime << " ms" << std::endl;
+	std::cout << "  Save snapshot: " << saveTime << " ms" << std::endl;
+	std::cout << "  Load snapshot: " << loadTime << " ms" << std::endl;
+
+	std::remove(path.c_str());
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+#include <toolkit/Sort.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace pet;
+
+namespace
+{
+	template <typename F>
+	double Measure(F&& func)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	template <typename Sort>
+	void Run(std::string_view name, const std::vector<int64_t>& input, Sort&& sort)
+	{
+		auto	   values = input;
+		const auto time = Measure([&]() { sort(values); });
+
+		std::cout << name << ": " << time << " ms" << (std::is_sorted(values.begin(), values.end()) ? "" : " (NOT SORTED)") << std::endl;
+	}
+
+	void RunAll(std::string_view name, const std::vector<int64_t>& input)
+	{
+		std::cout << name << " (" << input.size() << " values)" << std::endl;
+
+		Run("  std::sort", input, [](std::vector<int64_t>& values) { std::sort(values.begin(), values.end()); });
+		Run("  PdqSort  ", input, [](std::vector<int64_t>& values) { PdqSort(values.begin(), values.end(), std::less<>()); });
+		Run("  RadixSort", input, [](std::vector<int64_t>& values) { RadixSort(values.data(), values.size()); });
+	}
+}
+
+int main()
+{
+	constexpr size_t Count = 10000000;
+
+	std::mt19937_64 random(42);
+
+	std::vector<int64_t> uniform(Count);
+	for (auto& value : uniform) value = static_cast<int64_t>(random());
+
+	std::vector<int64_t> small(Count);
+	for (auto& value : small) value = static_cast<int64_t>(random() % 1000) - 500;
+
+	std::vector<int64_t> ascending(Count);
+	for (size_t i = 0; i < Count; ++i) ascending[i] = static_cast<int64_t>(i);
+
+	std::vector<int64_t> sawtooth(Count);
+	for (size_t i = 0; i < Count; ++i) sawtooth[i] = static_cast<int64_t>(i % 1000);
+
+	RunAll("Uniform", uniform);
+	RunAll("Small range", small);
+	RunAll("Ascending", ascending);
+	RunAll("Sawtooth", sawtooth);
+
+	return EXIT_SUCCESS;
+}
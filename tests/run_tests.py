@@ -1,9 +1,11 @@
 #!/bin/python3
 
 import argparse
+import mmap
 import os
 import shutil
 import subprocess
+import tempfile
 
 
 def main():
@@ -28,14 +30,90 @@ def main():
         for filename in filenames:
             if filename.endswith(".pet"):
                 expected_result = 1 if filename.endswith("_fail.pet") else 0
+                # A script with an .in file next to it reads that file as its standard input
+                input_path = os.path.join(dirpath, filename[:-len(".pet")] + ".in")
                 print(f"Running {filename}...")
-                result = subprocess.run(
-                    [time_path, "-f", "%E real\t%U user\t%S sys\t%M KB max-rss", args.pet_executable, os.path.join(dirpath, filename)]
-                )
+                with open(input_path) if os.path.exists(input_path) else open(os.devnull) as stdin:
+                    result = subprocess.run(
+                        [time_path, "-f", "%E real\t%U user\t%S sys\t%M KB max-rss", args.pet_executable, os.path.join(dirpath, filename)],
+                        stdin=stdin,
+                    )
                 if result.returncode != expected_result:
                     print(f"{filename} failed!")
                     return
 
+    # The REPL reads commands from the same standard input as the scripts it runs
+    repl_cases = [
+        ('var x = readln();\nhello\nprint("got:" + x);\n$quit\n', "got:hello"),
+        ("var x = readln();\n" + "a" * 600000 + "\nprint(len(x));\n$quit\n", "600000"),
+    ]
+    for repl_input, expected_output in repl_cases:
+        print(f"Running REPL with {len(repl_input)} bytes of input...")
+        result = subprocess.run([args.pet_executable], input=repl_input, capture_output=True, text=True)
+        if result.returncode != 0 or expected_output not in result.stdout:
+            print(f"REPL failed, expected '{expected_output}'!")
+            return
+
+    # Scripts run from compiled entries must behave as when parsed: the first run writes the entries, the second one uses them
+    with tempfile.TemporaryDirectory() as cache_dir:
+        for filename in sorted(os.listdir(scripts_dir)):
+            if not filename.endswith(".pet") or filename.endswith("_fail.pet"):
+                continue
+
+            input_path = os.path.join(scripts_dir, filename[:-len(".pet")] + ".in")
+            for run in ("writing", "reading"):
+                print(f"Running {filename} {run} the cache...")
+                with open(input_path) if os.path.exists(input_path) else open(os.devnull) as stdin:
+                    result = subprocess.run(
+                        [args.pet_executable, "--cache-dir", cache_dir, os.path.join(scripts_dir, filename)],
+                        stdin=stdin,
+                        stdout=subprocess.DEVNULL,
+                    )
+                if result.returncode != 0:
+                    print(f"{filename} failed {run} the cache!")
+                    return
+
+        # Entries hold parsed bodies, but a broken one still fails only when called
+        broken_path = os.path.join(scripts_dir, "fails", "lazy_function_syntax_fail.pet")
+        for run in ("writing", "reading"):
+            print(f"Running lazy_function_syntax_fail.pet {run} the cache...")
+            result = subprocess.run([args.pet_executable, "--cache-dir", cache_dir, broken_path], stderr=subprocess.DEVNULL)
+            if result.returncode != 1:
+                print(f"lazy_function_syntax_fail.pet failed {run} the cache!")
+                return
+
+        if not any(name.endswith(".petc") for name in os.listdir(cache_dir)):
+            print("No cache entry was written!")
+            return
+
+    # A state saved by one process is restored by another one
+    snapshots_dir = os.path.join(root_dir, "snapshots")
+    with tempfile.TemporaryDirectory() as snapshot_dir:
+        snapshot_path = os.path.join(snapshot_dir, "state.snapshot")
+        snapshot_runs = [
+            ("--save-snapshot", "save.pet"),
+            ("--load-snapshot", "load.pet"),
+        ]
+        for option, filename in snapshot_runs:
+            print(f"Running {filename} with {option}...")
+            result = subprocess.run([args.pet_executable, option, snapshot_path, os.path.join(snapshots_dir, filename)])
+            if result.returncode != 0:
+                print(f"{filename} failed!")
+                return
+
+        # Saving over a snapshot another process has mapped leaves that mapping intact
+        print("Running save.pet over a mapped snapshot...")
+        with open(snapshot_path, "rb") as snapshot:
+            mapping = mmap.mmap(snapshot.fileno(), 0, access=mmap.ACCESS_READ)
+            contents = mapping[:]
+            result = subprocess.run(
+                [args.pet_executable, "--save-snapshot", snapshot_path, os.path.join(snapshots_dir, "save.pet")]
+            )
+            if result.returncode != 0 or mapping[:] != contents or os.listdir(snapshot_dir) != ["state.snapshot"]:
+                print("save.pet failed over a mapped snapshot!")
+                return
+            mapping.close()
+
     print("Success!")
 
 